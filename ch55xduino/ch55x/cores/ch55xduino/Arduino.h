@@ -193,6 +193,20 @@ uint32_t millis(void);
  * @return Number of microseconds since the program started (uint32_t)
  */
 uint32_t micros(void);
+/**
+ * Same as millis(), but reads all five bytes of the Timer0 overflow count, so
+ * it does not go back to zero every 50 days. With the 8 bit Timer0 it wraps
+ * after about 4 years at 24 MHz (1.6 years at 56 MHz). Slower than millis().
+ * @return Number of milliseconds since the program started (uint64_t)
+ */
+uint64_t millis64(void);
+/**
+ * Same as micros(), but reads all five bytes of the Timer0 overflow count, so
+ * it does not go back to zero every 70 minutes. It wraps together with
+ * millis64(). Slower than micros().
+ * @return Number of microseconds since the program started (uint64_t)
+ */
+uint64_t micros64(void);
 /**
  * Pauses the program for the amount of time (in miliseconds) specified as
  * parameter. (There are 1000 milliseconds in a second.)
@@ -202,7 +216,9 @@ void delay(__data uint32_t ms);
 /**
  * Pauses the program for the amount of time (in microseconds) specified as
  * parameter. There are a thousand microseconds in a millisecond, and a million
- * microseconds in a second.
+ * microseconds in a second. Counts cycles, so it also works with interrupts
+ * off and inside interrupts. Below 12 MHz it waits whole loop passes of 2 to
+ * 64 us.
  * @param us the number of microseconds to pause (uint16_t)
  */
 void delayMicroseconds(__data uint16_t us);
@@ -219,6 +235,39 @@ void delayMicroseconds(__data uint16_t us);
  * complete pulse was received within the timeout.
  */
 uint32_t pulseIn(uint8_t pin, __xdata uint8_t state, __xdata uint16_t timeout);
+/**
+ * Changes the system clock while running, for example to save power while
+ * idle. micros(), millis() and delay() keep running at the right rate, the
+ * time left and the period of software timers and TASK_SLEEP() are converted
+ * to the new Timer0 rate (rounded to whole overflows again), and the Serial,
+ * SPI and PWM clock dividers are rescaled.
+ * delayMicroseconds(), pulseIn(), WS2812 and USB are timed for F_CPU and only
+ * work at that clock.
+ * @param freq the new clock in Hz, one of the clocks of the board menu (CH559:
+ * the PLL clock divided by 1 to 32, up to 56 MHz)
+ * @return 1 if the clock was changed, 0 if freq is not supported or would
+ * put the baud rate of a running Serial0 or Serial1 more than about 2.5% off,
+ * for example 115200 baud at 3 MHz. The clock is left alone then. (uint8_t)
+ */
+uint8_t setClock(__data uint32_t freq);
+/**
+ * Returns the current system clock, F_CPU until setClock() changes it.
+ * @return the clock in Hz (uint32_t)
+ */
+uint32_t getClock(void);
+/**
+ * Powers the chip down until one of the wake-up sources happens, then returns.
+ * The CH55x has no idle mode: the clock stops, so millis(), micros(), software
+ * timers and sleeping tasks do not advance while asleep. Call Serial0_flush()
+ * first if output is still queued. If the wake-up event also has its interrupt
+ * enabled (attachInterrupt(), serial receive), that interrupt runs on wake-up.
+ * @param wakeSources WAKE_CTRL bits, for example bWAK_P1_4_LO or bWAK_P1_5_LO
+ * (pin low), bWAK_RXD0_LO or bWAK_BY_USB, which every chip has. The INT0 edge
+ * or P3.3 low source is bWAK_P3_2E_3L on CH551/CH552/CH559 and
+ * bWAK_INT0E_P33L on CH549; P3.3 must not be held low by an output then.
+ * 0 returns right away.
+ */
+void sleepUntilWake(__data uint8_t wakeSources);
 
 // void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t
 // val); uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder);
@@ -227,6 +276,80 @@ void attachInterrupt(__data uint8_t interruptNum,
                      __xdata void (*userFunc)(void), __xdata uint8_t mode);
 void detachInterrupt(__data uint8_t interruptNum);
 
+#define SOFT_TIMER_NONE 0xFF
+/**
+ * Calls a function every us microseconds, from main() after loop() returns.
+ * The time is rounded up to whole Timer0 overflows (125 us at 24 MHz). Up to
+ * SOFT_TIMER_SLOTS (default 4) timers can run at once.
+ * @param us the interval in microseconds (uint32_t)
+ * @param callback the function to call
+ * @return the timer id for softTimer_stop(), or SOFT_TIMER_NONE if all
+ * slots are in use (uint8_t)
+ */
+uint8_t softTimer_every(__data uint32_t us, __xdata void (*callback)(void));
+/**
+ * Same as softTimer_every(), but calls the function only once.
+ * @param us the delay in microseconds (uint32_t)
+ * @param callback the function to call
+ * @return the timer id, or SOFT_TIMER_NONE (uint8_t)
+ */
+uint8_t softTimer_after(__data uint32_t us, __xdata void (*callback)(void));
+/**
+ * Stops a timer started by softTimer_every() or softTimer_after().
+ * @param id the timer id
+ */
+void softTimer_stop(__data uint8_t id);
+
+#define TASK_SLOTS 8
+/**
+ * Starts a cooperative task. The task function is called from yield(), which
+ * runs after every loop() and while delay() waits. Each call runs the task up
+ * to its next TASK_YIELD(), TASK_WAIT_UNTIL() or TASK_SLEEP().
+ * @param id 0 to TASK_SLOTS - 1. Also the priority, task 0 runs first.
+ * @param func the task function, written with TASK_BEGIN() and TASK_END()
+ */
+void task_start(__data uint8_t id, __xdata void (*func)(void));
+/**
+ * Stops a task. task_start() starts it again from the beginning.
+ * @param id the task id
+ */
+void task_stop(__data uint8_t id);
+/**
+ * Makes a suspended or sleeping task ready to run again. Can be called from an
+ * interrupt, it is reentrant. Ids of TASK_SLOTS and up, and tasks that were
+ * never started, are ignored.
+ * @param id the task id
+ */
+void task_ready(uint8_t id) __reentrant;
+// used by the TASK_ macros
+void task_suspend(void);
+void task_sleep(__data uint32_t us);
+
+// Tasks are stackless: the TASK_ macros return to yield() and jump back with a
+// switch on the line number. Local variables do not survive them, use static
+// variables instead, and put at most one macro on a line. A task must not call
+// delay(), use TASK_SLEEP().
+// clang-format off
+#define TASK_BEGIN() \
+  static __xdata uint16_t taskLine = 0; \
+  switch (taskLine) { \
+  case 0:
+#define TASK_YIELD() \
+  do { taskLine = __LINE__; return; case __LINE__:; } while (0)
+#define TASK_WAIT_UNTIL(condition) \
+  do { taskLine = __LINE__; case __LINE__: if (!(condition)) return; } while (0)
+// sleep for us microseconds, rounded up like softTimer_after()
+#define TASK_SLEEP(us) \
+  do { taskLine = __LINE__; task_sleep(us); return; case __LINE__:; } while (0)
+// wait for task_ready(), from an interrupt for example
+#define TASK_SUSPEND() \
+  do { taskLine = __LINE__; task_suspend(); return; case __LINE__:; } while (0)
+// the next run starts over at TASK_BEGIN(), like loop()
+#define TASK_END() \
+  } \
+  taskLine = 0;
+// clang-format on
+
 /**
  * The setup() function is called when a sketch starts. Use it to initialize
  * variables, pin modes, start using libraries, etc. The setup() function will
@@ -285,9 +408,54 @@ inline unsigned int makeWord(unsigned char h, unsigned char l) {
 bool USBSerial();
 uint8_t USBSerial_print_n(uint8_t *__xdata buf, __xdata int len);
 uint8_t USBSerial_write(__data char c);
+/**
+ * Write a zero terminated string to USB serial, like USBSerial_print_n but
+ * returning the count. Print functions use it for USB serial.
+ * @return number of characters written (uint8_t)
+ */
+uint8_t USBSerial_writeStr(char *str);
+/**
+ * Number of bytes USBSerial_tryWrite can take right now.
+ * @return free space in the packet being filled, 0 if it is busy (uint8_t)
+ */
+uint8_t USBSerial_availableForWrite(void);
+/**
+ * Queue up to len bytes from buf for USB serial. Never waits for the host.
+ * @return number of bytes queued (uint8_t)
+ */
+uint8_t USBSerial_tryWrite(uint8_t *__xdata buf, __xdata uint8_t len);
+#ifdef CDC_TX_DOUBLE_BUFFER
+/**
+ * Send len bytes straight from an xdata buffer, without copying them.
+ * buf must be at an even address and left untouched until
+ * USBSerial_blockBusy() returns false. Bytes written before, and the previous
+ * block, are sent first; it waits for them like USBSerial_write() does.
+ * @return 1 if the block was started, 0 if the port is closed or the earlier
+ * data did not go out within USB_CDC_WRITE_TIMEOUT_MS (at once when it is 0).
+ * Nothing of the block is sent then, call it again. (uint8_t)
+ */
+uint8_t USBSerial_sendBlock(__xdata uint8_t *buf, __xdata uint16_t len);
+bool USBSerial_blockBusy(void);
+#endif
+#ifdef USB_CDC_UART_BRIDGE
+void USBSerial_bridgePoll(void);
+/**
+ * Counts bytes received on Serial0 that the bridge dropped because both USB
+ * IN packets were full, as when the host does not read the port fast enough.
+ * @return the count since start up, wraps at 65536 (uint16_t)
+ */
+uint16_t USBSerial_bridgeDropped(void);
+void uart0BridgeRxHandler(void);
+void uart0BridgeTxHandler(void);
+#endif
 void USBSerial_flush(void);
 uint8_t USBSerial_available();
 char USBSerial_read();
+/**
+ * Copy up to len received bytes into buf without waiting for more.
+ * @return number of bytes copied (uint8_t)
+ */
+uint8_t USBSerial_readBytes(uint8_t *__xdata buf, __xdata uint8_t len);
 #include "Print.h"
 
 // Generic selection for print
@@ -303,6 +471,8 @@ char USBSerial_read();
 #define USBSerial_print_ub(P, Q) (Print_print_ub(USBSerial_write, (P), (Q)))
 #define USBSerial_print_f(P) (Print_print_f(USBSerial_write, (P)))
 #define USBSerial_print_fd(P, Q) (Print_print_fd(USBSerial_write, (P), (Q)))
+#define USBSerial_print_q(P, B, D)                                             \
+  (Print_print_q(USBSerial_write, (P), (B), (D)))
 #define USBSerial_print_c(P) ((USBSerial_write(P)))
 
 #define USBSerial_println_only() (Print_println(USBSerial_write))
@@ -322,6 +492,9 @@ char USBSerial_read();
   (Print_print_f(USBSerial_write, (P)) + Print_println(USBSerial_write))
 #define USBSerial_println_fd(P, Q)                                             \
   (Print_print_fd(USBSerial_write, (P), (Q)) + Print_println(USBSerial_write))
+#define USBSerial_println_q(P, B, D)                                           \
+  (Print_print_q(USBSerial_write, (P), (B), (D)) +                             \
+   Print_println(USBSerial_write))
 #define USBSerial_println_c(P)                                                 \
   ((USBSerial_write(P)) + Print_println(USBSerial_write))
 
@@ -333,6 +506,7 @@ char USBSerial_read();
 #define Serial0_print_ub(P, Q) (Print_print_ub(Serial0_write, (P), (Q)))
 #define Serial0_print_f(P) (Print_print_f(Serial0_write, (P)))
 #define Serial0_print_fd(P, Q) (Print_print_fd(Serial0_write, (P), (Q)))
+#define Serial0_print_q(P, B, D) (Print_print_q(Serial0_write, (P), (B), (D)))
 #define Serial0_print_c(P) ((Serial0_write(P)))
 
 #define Serial0_println_only() (Print_println(Serial0_write))
@@ -352,6 +526,8 @@ char USBSerial_read();
   (Print_print_f(Serial0_write, (P)) + Print_println(Serial0_write))
 #define Serial0_println_fd(P, Q)                                               \
   (Print_print_fd(Serial0_write, (P), (Q)) + Print_println(Serial0_write))
+#define Serial0_println_q(P, B, D)                                             \
+  (Print_print_q(Serial0_write, (P), (B), (D)) + Print_println(Serial0_write))
 #define Serial0_println_c(P) ((Serial0_write(P)) + Print_println(Serial0_write))
 
 #define Serial1_print_s(P) (Print_print_s(Serial1_write, (P)))
@@ -362,6 +538,7 @@ char USBSerial_read();
 #define Serial1_print_ub(P, Q) (Print_print_ub(Serial1_write, (P), (Q)))
 #define Serial1_print_f(P) (Print_print_f(Serial1_write, (P)))
 #define Serial1_print_fd(P, Q) (Print_print_fd(Serial1_write, (P), (Q)))
+#define Serial1_print_q(P, B, D) (Print_print_q(Serial1_write, (P), (B), (D)))
 #define Serial1_print_c(P) ((Serial1_write(P)))
 
 #define Serial1_println_only() (Print_println(Serial1_write))
@@ -381,8 +558,91 @@ char USBSerial_read();
   (Print_print_f(Serial1_write, (P)) + Print_println(Serial1_write))
 #define Serial1_println_fd(P, Q)                                               \
   (Print_print_fd(Serial1_write, (P), (Q)) + Print_println(Serial1_write))
+#define Serial1_println_q(P, B, D)                                             \
+  (Print_print_q(Serial1_write, (P), (B), (D)) + Print_println(Serial1_write))
 #define Serial1_println_c(P) ((Serial1_write(P)) + Print_println(Serial1_write))
 
+// Profiling. Regions are numbered 0 to PROFILE_REGIONS - 1 (default 4). Call
+// from main() code only, not from interrupts. Regions may nest but an id must
+// not be reentered.
+#define PROFILE_BEGIN(id) Profile_begin(id)
+#define PROFILE_END(id) Profile_end(id)
+void Profile_begin(__data uint8_t id);
+void Profile_end(__data uint8_t id);
+/**
+ * Clears the times of all profiling regions.
+ */
+void Profile_reset(void);
+/**
+ * Prints a line for every profiling region that ran: its id, how many times it
+ * ran, the min, max and average time in cycles (12 cycle resolution), and a
+ * histogram of the times. For example Profile_dump(USBSerial_write) or
+ * Profile_dump(Serial0_write).
+ * @param writefunc the write function of the port to print to
+ */
+void Profile_dump(__data writefunc_p writefunc);
+
+// Binary telemetry. A record is built with Telemetry_begin(), the values and
+// Telemetry_end(), or in one go with Telemetry_send(). It goes out as a COBS
+// frame with a CRC, util/telemetry_decode.py reads it on the PC. Up to
+// TELEMETRY_SIZE (default 32) bytes of values per record. USB serial sends it
+// on USBSerial_flush() or the next auto flush, like printed text.
+/**
+ * Starts a record.
+ * @param writefunc the write function of the port to send to, for example
+ * USBSerial_write or Serial0_write
+ * @param type a number for the kind of record, the decoder picks the value
+ * layout with it
+ */
+void Telemetry_begin(__data writefunc_p writefunc, __data uint8_t type);
+void Telemetry_u8(__data uint8_t v);
+void Telemetry_u16(__data uint16_t v);
+void Telemetry_u32(__data uint32_t v);
+void Telemetry_f(__data float v);
+/**
+ * Sends the record started by Telemetry_begin().
+ * @return the number of bytes sent, 0 if the values did not fit
+ */
+uint8_t Telemetry_end(void);
+// Up to 8 values, each added as 1, 2 or 4 bytes by its type like the print()
+// macros, for example Telemetry_send(Serial0_write, 1, temperature, humidity)
+// sends a float and an int as "<fH" to the decoder. int is 16 bit on SDCC.
+#define Telemetry_send(W, T, ...)                                              \
+  (Telemetry_begin(W, T),                                                      \
+   CONCAT(TELEMETRY_SEND_, PRINT_ALL_NARG(__VA_ARGS__))(__VA_ARGS__),          \
+   Telemetry_end())
+#define USBSerial_telemetry(...) Telemetry_send(USBSerial_write, __VA_ARGS__)
+#define Serial0_telemetry(...) Telemetry_send(Serial0_write, __VA_ARGS__)
+#define Serial1_telemetry(...) Telemetry_send(Serial1_write, __VA_ARGS__)
+
+#define TELEMETRY_SELECT(_1)                                                   \
+  _Generic((_1),                                                               \
+      char: Telemetry_u8,                                                      \
+      signed char: Telemetry_u8,                                               \
+      unsigned char: Telemetry_u8,                                             \
+      int: Telemetry_u16,                                                      \
+      short: Telemetry_u16,                                                    \
+      unsigned int: Telemetry_u16,                                             \
+      unsigned short: Telemetry_u16,                                           \
+      long: Telemetry_u32,                                                     \
+      unsigned long: Telemetry_u32,                                            \
+      float: Telemetry_f)(_1)
+#define TELEMETRY_SEND_1(_1) TELEMETRY_SELECT(_1)
+#define TELEMETRY_SEND_2(_1, ...)                                              \
+  TELEMETRY_SELECT(_1), TELEMETRY_SEND_1(__VA_ARGS__)
+#define TELEMETRY_SEND_3(_1, ...)                                              \
+  TELEMETRY_SELECT(_1), TELEMETRY_SEND_2(__VA_ARGS__)
+#define TELEMETRY_SEND_4(_1, ...)                                              \
+  TELEMETRY_SELECT(_1), TELEMETRY_SEND_3(__VA_ARGS__)
+#define TELEMETRY_SEND_5(_1, ...)                                              \
+  TELEMETRY_SELECT(_1), TELEMETRY_SEND_4(__VA_ARGS__)
+#define TELEMETRY_SEND_6(_1, ...)                                              \
+  TELEMETRY_SELECT(_1), TELEMETRY_SEND_5(__VA_ARGS__)
+#define TELEMETRY_SEND_7(_1, ...)                                              \
+  TELEMETRY_SELECT(_1), TELEMETRY_SEND_6(__VA_ARGS__)
+#define TELEMETRY_SEND_8(_1, ...)                                              \
+  TELEMETRY_SELECT(_1), TELEMETRY_SEND_7(__VA_ARGS__)
+
 // 10K lifecycle DataFlash access on CH551/CH552.
 void eeprom_write_byte(__data uint8_t addr, __xdata uint8_t val);
 uint8_t eeprom_read_byte(__data uint8_t addr);
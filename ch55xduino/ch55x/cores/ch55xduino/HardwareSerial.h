@@ -7,19 +7,64 @@
 #include "include/ch5xx.h"
 // clang-format on
 
+// Sizes come from the "Serial buffers" menu. They must be powers of two, up
+// to 256, so ring indexes wrap with a mask instead of a division.
+#ifndef SERIAL0_TX_BUFFER_SIZE
 #define SERIAL0_TX_BUFFER_SIZE 16
+#endif
+#ifndef SERIAL0_RX_BUFFER_SIZE
 #define SERIAL0_RX_BUFFER_SIZE 16
+#endif
+#ifndef SERIAL1_TX_BUFFER_SIZE
 #define SERIAL1_TX_BUFFER_SIZE 16
+#endif
+#ifndef SERIAL1_RX_BUFFER_SIZE
 #define SERIAL1_RX_BUFFER_SIZE 16
+#endif
+
+#define SERIAL_BUFFER_SIZE_BAD(size)                                           \
+  (((size) & ((size)-1)) || ((size) < 2) || ((size) > 256))
+#if SERIAL_BUFFER_SIZE_BAD(SERIAL0_TX_BUFFER_SIZE) ||                          \
+    SERIAL_BUFFER_SIZE_BAD(SERIAL0_RX_BUFFER_SIZE) ||                          \
+    SERIAL_BUFFER_SIZE_BAD(SERIAL1_TX_BUFFER_SIZE) ||                          \
+    SERIAL_BUFFER_SIZE_BAD(SERIAL1_RX_BUFFER_SIZE)
+#error "Serial buffer sizes must be a power of two from 2 to 256"
+#endif
+
+#define SERIAL0_TX_MASK (SERIAL0_TX_BUFFER_SIZE - 1)
+#define SERIAL0_RX_MASK (SERIAL0_RX_BUFFER_SIZE - 1)
+#define SERIAL1_TX_MASK (SERIAL1_TX_BUFFER_SIZE - 1)
+#define SERIAL1_RX_MASK (SERIAL1_RX_BUFFER_SIZE - 1)
 
 #define UART0_FLG_SENDING (1 << 0)
 
+#if defined(CH559) && defined(SERIAL1_FIFO_TRIG)
+// UART1 of CH559 has 8 byte FIFOs. The RX interrupt comes when
+// SERIAL1_FIFO_TRIG bytes are waiting, or after a timeout for fewer.
+#define SERIAL1_FIFO_SIZE 8
+#if SERIAL1_FIFO_TRIG == 1
+#define SERIAL1_FCR_TRIG 0
+#elif SERIAL1_FIFO_TRIG == 2
+#define SERIAL1_FCR_TRIG bFCR_FIFO_TRIG0
+#elif SERIAL1_FIFO_TRIG == 4
+#define SERIAL1_FCR_TRIG bFCR_FIFO_TRIG1
+#elif SERIAL1_FIFO_TRIG == 7
+#define SERIAL1_FCR_TRIG (bFCR_FIFO_TRIG1 | bFCR_FIFO_TRIG0)
+#else
+#error "SERIAL1_FIFO_TRIG must be 1, 2, 4 or 7"
+#endif
+#endif
+
 uint8_t Serial0(void);
 void Serial0_begin(__data unsigned long baud);
 
 uint8_t Serial0_available(void);
+uint8_t Serial0_availableForWrite(void);
 uint8_t Serial0_read(void);
 uint8_t Serial0_write(__data uint8_t c);
+uint8_t Serial0_readBytes(uint8_t *__xdata buf, __xdata uint8_t len);
+uint8_t Serial0_writeBytes(uint8_t *__xdata buf, __xdata uint8_t len);
+uint8_t Serial0_writeStr(char *str);
 void Serial0_flush(void);
 
 void Serial0_end(void);
@@ -31,8 +76,12 @@ uint8_t Serial1(void);
 void Serial1_begin(__data unsigned long baud);
 
 uint8_t Serial1_available(void);
+uint8_t Serial1_availableForWrite(void);
 uint8_t Serial1_read(void);
 uint8_t Serial1_write(__data uint8_t c);
+uint8_t Serial1_readBytes(uint8_t *__xdata buf, __xdata uint8_t len);
+uint8_t Serial1_writeBytes(uint8_t *__xdata buf, __xdata uint8_t len);
+uint8_t Serial1_writeStr(char *str);
 void Serial1_flush(void);
 
 void Serial1_end(void);
@@ -3,6 +3,7 @@
  */
 
 #include "HardwareSerial.h"
+#include "Print.h"
 
 __xdata unsigned char serial0Initialized;
 
@@ -53,39 +54,45 @@ void Serial0_begin(__data unsigned long baud) {
 
   ES = 1; // Enable serial 0 interrupt
 
+  Print_setStringWrite(Serial0_write, Serial0_writeStr);
   serial0Initialized = 1;
 }
 
-uint8_t Serial0_write(__data uint8_t SendDat) {
-  __data uint8_t interruptOn = EA;
-  EA = 0;
-  if ((uart0_tx_buffer_head == uart0_tx_buffer_tail) &&
-      (uart0_flag_sending == 0)) { // start to send
+// The TX ring needs no interrupt disable: the sketch only moves head, the
+// interrupt only moves tail. The interrupt clears uart0_flag_sending only
+// when it finds the ring empty, and with the flag clear it leaves tail
+// alone. The flag being clear does not mean a byte waits: the interrupt may
+// have sent the byte just queued before finding the ring empty. So the
+// sketch starts sending only if head != tail as well, which cannot change
+// under it while the flag is clear. tail moves before SBUF is written, in
+// case the TX interrupt runs right after.
+void Serial0_startSending(void) {
+  if (uart0_flag_sending == 0 &&
+      uart0_tx_buffer_head != uart0_tx_buffer_tail) {
+    __data uint8_t tail = uart0_tx_buffer_tail;
+    __data uint8_t c = Transmit_Uart0_Buf[tail];
+    uart0_tx_buffer_tail = (tail + 1) & SERIAL0_TX_MASK;
     uart0_flag_sending = 1;
-    SBUF = SendDat;
-    if (interruptOn)
-      EA = 1;
-    return 1;
+    SBUF = c;
   }
+}
 
-  __data uint8_t nextHeadPos =
-      ((uint8_t)(uart0_tx_buffer_head + 1)) % SERIAL0_TX_BUFFER_SIZE;
+uint8_t Serial0_write(__data uint8_t SendDat) {
+  __data uint8_t head = uart0_tx_buffer_head;
+  __data uint8_t nextHeadPos = ((uint8_t)(head + 1)) & SERIAL0_TX_MASK;
 
   __data uint16_t waitWriteCount = 0;
   while ((nextHeadPos == uart0_tx_buffer_tail)) { // wait max 100ms or discard
-    if (interruptOn)
-      EA = 1;
     waitWriteCount++;
     delayMicroseconds(5);
     if (waitWriteCount >= 20000)
       return 0;
   }
-  Transmit_Uart0_Buf[uart0_tx_buffer_head] = SendDat;
+  Transmit_Uart0_Buf[head] = SendDat;
 
   uart0_tx_buffer_head = nextHeadPos;
 
-  if (interruptOn)
-    EA = 1;
+  Serial0_startSending();
 
   return 1;
 }
@@ -95,24 +102,104 @@ void Serial0_flush(void) {
     ;
 }
 
+uint8_t Serial0_availableForWrite(void) {
+  return ((uint8_t)(uart0_tx_buffer_tail - uart0_tx_buffer_head - 1)) &
+         SERIAL0_TX_MASK;
+}
+
 uint8_t Serial0_available(void) {
   __data uint8_t rxBufLength =
-      ((uint8_t)(SERIAL0_RX_BUFFER_SIZE + uart0_rx_buffer_head -
-                 uart0_rx_buffer_tail)) %
-      SERIAL0_RX_BUFFER_SIZE;
+      ((uint8_t)(uart0_rx_buffer_head - uart0_rx_buffer_tail)) &
+      SERIAL0_RX_MASK;
   return rxBufLength;
 }
 
 uint8_t Serial0_read(void) {
   __data uint8_t rxBufLength =
-      ((uint8_t)(SERIAL0_RX_BUFFER_SIZE + uart0_rx_buffer_head -
-                 uart0_rx_buffer_tail)) %
-      SERIAL0_RX_BUFFER_SIZE;
+      ((uint8_t)(uart0_rx_buffer_head - uart0_rx_buffer_tail)) &
+      SERIAL0_RX_MASK;
   if (rxBufLength > 0) {
     __data uint8_t result = Receive_Uart0_Buf[uart0_rx_buffer_tail];
     uart0_rx_buffer_tail =
-        (((uint8_t)(uart0_rx_buffer_tail + 1)) % SERIAL0_RX_BUFFER_SIZE);
+        (((uint8_t)(uart0_rx_buffer_tail + 1)) & SERIAL0_RX_MASK);
     return result;
   }
   return 0;
 }
+
+// Copies what has arrived, up to len bytes, without waiting
+uint8_t Serial0_readBytes(uint8_t *__xdata buf, __xdata uint8_t len) {
+  __data uint8_t count = 0;
+  __data uint8_t head = uart0_rx_buffer_head;
+  __data uint8_t tail = uart0_rx_buffer_tail;
+  while (count < len && head != tail) {
+    *buf++ = Receive_Uart0_Buf[tail];
+    tail = (tail + 1) & SERIAL0_RX_MASK;
+    count++;
+  }
+  uart0_rx_buffer_tail = tail;
+  return count;
+}
+
+// Fills the free part of the ring in one go, then publishes it. Waits like
+// Serial0_write when the ring is full.
+uint8_t Serial0_writeBytes(uint8_t *__xdata buf, __xdata uint8_t len) {
+  __data uint8_t count = 0;
+  __data uint16_t waitWriteCount = 0;
+  while (count < len) {
+    __data uint8_t head = uart0_tx_buffer_head;
+    __data uint8_t room =
+        ((uint8_t)(uart0_tx_buffer_tail - head - 1)) & SERIAL0_TX_MASK;
+    if (room == 0) { // wait max 100ms or discard
+      waitWriteCount++;
+      delayMicroseconds(5);
+      if (waitWriteCount >= 20000)
+        break;
+      continue;
+    }
+    waitWriteCount = 0;
+    if (room > len - count)
+      room = len - count;
+    count += room;
+    while (room--) {
+      Transmit_Uart0_Buf[head] = *buf++;
+      head = (head + 1) & SERIAL0_TX_MASK;
+    }
+
+    uart0_tx_buffer_head = head;
+    Serial0_startSending();
+  }
+  return count;
+}
+
+// Like Serial0_writeBytes, for a zero terminated string. Registered with
+// Print_setStringWrite() by Serial0_begin, so Serial0 prints fill the ring
+// without a call per character.
+uint8_t Serial0_writeStr(char *str) {
+  __data uint8_t count = 0;
+  __data uint16_t waitWriteCount = 0;
+  __data char c = *str;
+  while (c) {
+    __data uint8_t head = uart0_tx_buffer_head;
+    __data uint8_t room =
+        ((uint8_t)(uart0_tx_buffer_tail - head - 1)) & SERIAL0_TX_MASK;
+    if (room == 0) { // wait max 100ms or discard
+      waitWriteCount++;
+      delayMicroseconds(5);
+      if (waitWriteCount >= 20000)
+        break;
+      continue;
+    }
+    waitWriteCount = 0;
+    do {
+      Transmit_Uart0_Buf[head] = c;
+      head = (head + 1) & SERIAL0_TX_MASK;
+      count++;
+      c = *++str;
+    } while (--room && c);
+
+    uart0_tx_buffer_head = head;
+    Serial0_startSending();
+  }
+  return count;
+}
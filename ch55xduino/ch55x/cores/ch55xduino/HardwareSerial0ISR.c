@@ -15,7 +15,7 @@ volatile __xdata uint8_t uart0_tx_buffer_tail = 0;
 volatile __bit uart0_flag_sending = 0;
 
 void uart0IntRxHandler() {
-  __data uint8_t nextHead = (uart0_rx_buffer_head + 1) % SERIAL0_RX_BUFFER_SIZE;
+  __data uint8_t nextHead = (uart0_rx_buffer_head + 1) & SERIAL0_RX_MASK;
 
   if (nextHead != uart0_rx_buffer_tail) {
     Receive_Uart0_Buf[uart0_rx_buffer_head] = SBUF;
@@ -30,8 +30,7 @@ void uart0IntTxHandler() {
       uart0_flag_sending &= 0;
     } else {
       SBUF = Transmit_Uart0_Buf[uart0_tx_buffer_tail];
-      uart0_tx_buffer_tail =
-          (uart0_tx_buffer_tail + 1) % SERIAL0_TX_BUFFER_SIZE;
+      uart0_tx_buffer_tail = (uart0_tx_buffer_tail + 1) & SERIAL0_TX_MASK;
     }
   }
 }
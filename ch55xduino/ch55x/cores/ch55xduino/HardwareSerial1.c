@@ -1,4 +1,5 @@
 #include "HardwareSerial.h"
+#include "Print.h"
 
 __xdata unsigned char serial1Initialized;
 
@@ -44,6 +45,10 @@ void Serial1_begin(__data unsigned long baud) {
   SER1_IER =
       bIER_PIN_MOD1 | bIER_THR_EMPTY | bIER_RECV_RDY; // RXD1:P2.6 TXD1:P2.7
   SER1_MCR |= bMCR_OUT2;
+#ifdef SERIAL1_FIFO_TRIG
+  SER1_FCR =
+      SERIAL1_FCR_TRIG | bFCR_T_FIFO_CLR | bFCR_R_FIFO_CLR | bFCR_FIFO_EN;
+#endif
   IE_UART1 = 1;
   EA = 1;
 #elif defined(CH549)
@@ -53,46 +58,51 @@ void Serial1_begin(__data unsigned long baud) {
   IE_UART1 = 1;
   EA = 1;
 #endif
+  Print_setStringWrite(Serial1_write, Serial1_writeStr);
   serial1Initialized = 1;
 }
 
-uint8_t Serial1_write(__data uint8_t SendDat) {
-  __data uint8_t interruptOn = EA;
-  EA = 0;
-
-  if ((uart1_tx_buffer_head == uart1_tx_buffer_tail) &&
-      (uart1_flag_sending == 0)) { // start to send
+// The TX ring needs no interrupt disable: the sketch only moves head, the
+// interrupt only moves tail. The interrupt clears uart1_flag_sending only
+// when it finds the ring empty, and with the flag clear it leaves tail
+// alone. The flag being clear does not mean a byte waits: the interrupt may
+// have sent the byte just queued before finding the ring empty. So the
+// sketch starts sending only if head != tail as well, which cannot change
+// under it while the flag is clear. tail moves before SBUF is written, in
+// case the TX interrupt runs right after.
+void Serial1_startSending(void) {
+  if (uart1_flag_sending == 0 &&
+      uart1_tx_buffer_head != uart1_tx_buffer_tail) {
+    __data uint8_t tail = uart1_tx_buffer_tail;
+    __data uint8_t c = Transmit_Uart1_Buf[tail];
+    uart1_tx_buffer_tail = (tail + 1) & SERIAL1_TX_MASK;
     uart1_flag_sending = 1;
 #if defined(CH551) || defined(CH552)
-    SBUF1 = SendDat;
+    SBUF1 = c;
 #elif defined(CH559)
-    SER1_THR = SendDat;
+    SER1_THR = c;
 #elif defined(CH549)
-    SBUF1 = SendDat;
+    SBUF1 = c;
 #endif
-    if (interruptOn)
-      EA = 1;
-    return 1;
   }
+}
 
-  __data uint8_t nextHeadPos =
-      ((uint8_t)(uart1_tx_buffer_head + 1)) % SERIAL1_TX_BUFFER_SIZE;
+uint8_t Serial1_write(__data uint8_t SendDat) {
+  __data uint8_t head = uart1_tx_buffer_head;
+  __data uint8_t nextHeadPos = ((uint8_t)(head + 1)) & SERIAL1_TX_MASK;
 
   __data uint16_t waitWriteCount = 0;
   while ((nextHeadPos == uart1_tx_buffer_tail)) { // wait max 100ms or discard
-    if (interruptOn)
-      EA = 1;
     waitWriteCount++;
     delayMicroseconds(5);
     if (waitWriteCount >= 20000)
       return 0;
   }
-  Transmit_Uart1_Buf[uart1_tx_buffer_head] = SendDat;
+  Transmit_Uart1_Buf[head] = SendDat;
 
   uart1_tx_buffer_head = nextHeadPos;
 
-  if (interruptOn)
-    EA = 1;
+  Serial1_startSending();
 
   return 1;
 }
@@ -102,24 +112,104 @@ void Serial1_flush(void) {
     ;
 }
 
+uint8_t Serial1_availableForWrite(void) {
+  return ((uint8_t)(uart1_tx_buffer_tail - uart1_tx_buffer_head - 1)) &
+         SERIAL1_TX_MASK;
+}
+
 uint8_t Serial1_available(void) {
   __data uint8_t rxBufLength =
-      ((uint8_t)(SERIAL1_RX_BUFFER_SIZE + uart1_rx_buffer_head -
-                 uart1_rx_buffer_tail)) %
-      SERIAL1_RX_BUFFER_SIZE;
+      ((uint8_t)(uart1_rx_buffer_head - uart1_rx_buffer_tail)) &
+      SERIAL1_RX_MASK;
   return rxBufLength;
 }
 
 uint8_t Serial1_read(void) {
   __data uint8_t rxBufLength =
-      ((uint8_t)(SERIAL1_RX_BUFFER_SIZE + uart1_rx_buffer_head -
-                 uart1_rx_buffer_tail)) %
-      SERIAL1_RX_BUFFER_SIZE;
+      ((uint8_t)(uart1_rx_buffer_head - uart1_rx_buffer_tail)) &
+      SERIAL1_RX_MASK;
   if (rxBufLength > 0) {
     __data uint8_t result = Receive_Uart1_Buf[uart1_rx_buffer_tail];
     uart1_rx_buffer_tail =
-        (((uint8_t)(uart1_rx_buffer_tail + 1)) % SERIAL1_RX_BUFFER_SIZE);
+        (((uint8_t)(uart1_rx_buffer_tail + 1)) & SERIAL1_RX_MASK);
     return result;
   }
   return 0;
 }
+
+// Copies what has arrived, up to len bytes, without waiting
+uint8_t Serial1_readBytes(uint8_t *__xdata buf, __xdata uint8_t len) {
+  __data uint8_t count = 0;
+  __data uint8_t head = uart1_rx_buffer_head;
+  __data uint8_t tail = uart1_rx_buffer_tail;
+  while (count < len && head != tail) {
+    *buf++ = Receive_Uart1_Buf[tail];
+    tail = (tail + 1) & SERIAL1_RX_MASK;
+    count++;
+  }
+  uart1_rx_buffer_tail = tail;
+  return count;
+}
+
+// Fills the free part of the ring in one go, then publishes it. Waits like
+// Serial1_write when the ring is full.
+uint8_t Serial1_writeBytes(uint8_t *__xdata buf, __xdata uint8_t len) {
+  __data uint8_t count = 0;
+  __data uint16_t waitWriteCount = 0;
+  while (count < len) {
+    __data uint8_t head = uart1_tx_buffer_head;
+    __data uint8_t room =
+        ((uint8_t)(uart1_tx_buffer_tail - head - 1)) & SERIAL1_TX_MASK;
+    if (room == 0) { // wait max 100ms or discard
+      waitWriteCount++;
+      delayMicroseconds(5);
+      if (waitWriteCount >= 20000)
+        break;
+      continue;
+    }
+    waitWriteCount = 0;
+    if (room > len - count)
+      room = len - count;
+    count += room;
+    while (room--) {
+      Transmit_Uart1_Buf[head] = *buf++;
+      head = (head + 1) & SERIAL1_TX_MASK;
+    }
+
+    uart1_tx_buffer_head = head;
+    Serial1_startSending();
+  }
+  return count;
+}
+
+// Like Serial1_writeBytes, for a zero terminated string. Registered with
+// Print_setStringWrite() by Serial1_begin, so Serial1 prints fill the ring
+// without a call per character.
+uint8_t Serial1_writeStr(char *str) {
+  __data uint8_t count = 0;
+  __data uint16_t waitWriteCount = 0;
+  __data char c = *str;
+  while (c) {
+    __data uint8_t head = uart1_tx_buffer_head;
+    __data uint8_t room =
+        ((uint8_t)(uart1_tx_buffer_tail - head - 1)) & SERIAL1_TX_MASK;
+    if (room == 0) { // wait max 100ms or discard
+      waitWriteCount++;
+      delayMicroseconds(5);
+      if (waitWriteCount >= 20000)
+        break;
+      continue;
+    }
+    waitWriteCount = 0;
+    do {
+      Transmit_Uart1_Buf[head] = c;
+      head = (head + 1) & SERIAL1_TX_MASK;
+      count++;
+      c = *++str;
+    } while (--room && c);
+
+    uart1_tx_buffer_head = head;
+    Serial1_startSending();
+  }
+  return count;
+}
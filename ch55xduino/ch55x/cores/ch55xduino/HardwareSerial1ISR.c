@@ -10,8 +10,42 @@ volatile __xdata uint8_t uart1_tx_buffer_head = 0;
 volatile __xdata uint8_t uart1_tx_buffer_tail = 0;
 volatile __bit uart1_flag_sending = 0;
 
+#if defined(CH559) && defined(SERIAL1_FIFO_TRIG)
+// Drain the whole RX FIFO per interrupt. Bytes that don't fit in the ring are
+// read and dropped, otherwise the interrupt would keep firing.
 void uart1IntRxHandler() {
-  __data uint8_t nextHead = (uart1_rx_buffer_head + 1) % SERIAL1_RX_BUFFER_SIZE;
+  __data uint8_t head = uart1_rx_buffer_head;
+  while (SER1_LSR & bLSR_DATA_RDY) {
+    __data uint8_t c = SER1_RBR;
+    __data uint8_t nextHead = (head + 1) & SERIAL1_RX_MASK;
+    if (nextHead != uart1_rx_buffer_tail) {
+      Receive_Uart1_Buf[head] = c;
+      head = nextHead;
+    }
+  }
+  uart1_rx_buffer_head = head;
+}
+
+// Refill the whole TX FIFO per THR empty interrupt
+void uart1IntTxHandler() {
+  if (uart1_flag_sending) {
+    __data uint8_t tail = uart1_tx_buffer_tail;
+    if (uart1_tx_buffer_head == tail) {
+      // do no more
+      uart1_flag_sending &= 0;
+    } else {
+      for (__data uint8_t i = SERIAL1_FIFO_SIZE;
+           i > 0 && uart1_tx_buffer_head != tail; i--) {
+        SER1_THR = Transmit_Uart1_Buf[tail];
+        tail = (tail + 1) & SERIAL1_TX_MASK;
+      }
+      uart1_tx_buffer_tail = tail;
+    }
+  }
+}
+#else
+void uart1IntRxHandler() {
+  __data uint8_t nextHead = (uart1_rx_buffer_head + 1) & SERIAL1_RX_MASK;
 
   if (nextHead != uart1_rx_buffer_tail) {
 #if defined(CH551) || defined(CH552)
@@ -38,8 +72,8 @@ void uart1IntTxHandler() {
 #elif defined(CH549)
       SBUF1 = Transmit_Uart1_Buf[uart1_tx_buffer_tail];
 #endif
-      uart1_tx_buffer_tail =
-          (uart1_tx_buffer_tail + 1) % SERIAL1_TX_BUFFER_SIZE;
+      uart1_tx_buffer_tail = (uart1_tx_buffer_tail + 1) & SERIAL1_TX_MASK;
     }
   }
 }
+#endif
@@ -0,0 +1,39 @@
+// String writes for Print. An output that can take a whole string faster
+// than one writefunc call per character registers that function here, and
+// Print_print_s() uses it for strings and formatted numbers sent to that
+// writefunc. SDCC can only pass one parameter through a function pointer to
+// a non reentrant function, so it takes a zero terminated string instead of
+// a pointer and a length. Not reentrant, register from main code only.
+
+#include "Arduino.h"
+
+#ifndef PRINT_STRING_WRITE_SLOTS
+#define PRINT_STRING_WRITE_SLOTS 4 // USB serial, Serial0, Serial1, printAll
+#endif
+
+__xdata writefunc_p printStringOwner[PRINT_STRING_WRITE_SLOTS];
+__xdata writefunc_s_p printStringWrite[PRINT_STRING_WRITE_SLOTS];
+
+void Print_setStringWrite(__data writefunc_p writefunc,
+                          __xdata writefunc_s_p writefunc_s) {
+  __data uint8_t i;
+
+  for (i = 0; i < PRINT_STRING_WRITE_SLOTS; i++) {
+    if (printStringOwner[i] == writefunc || printStringOwner[i] == NULL) {
+      printStringWrite[i] = writefunc_s;
+      printStringOwner[i] = writefunc;
+      return;
+    }
+  }
+}
+
+writefunc_s_p Print_getStringWrite(__data writefunc_p writefunc) {
+  __data uint8_t i;
+
+  for (i = 0; i < PRINT_STRING_WRITE_SLOTS; i++) {
+    if (printStringOwner[i] == writefunc) {
+      return printStringWrite[i];
+    }
+  }
+  return NULL;
+}
@@ -29,59 +29,124 @@
 // #include <stdio.h>
 // #include <string.h>
 #include "Arduino.h"
-#include <math.h>
 
 #include "Print.h"
 
 // Public Methods //////////////////////////////////////////////////////////////
 
-uint8_t Print_print_fd(__data writefunc_p writefunc, __xdata double number,
-                       __xdata uint8_t digits) {
+// 0.5 / 10^digits as a 32 bit binary fraction, rounded up so exact halves
+// like 0.125 with 2 digits round up as they did with float math
+static __code uint32_t printRounding[10] = {
+    0x80000000UL, 0x0CCCCCCDUL, 0x0147AE15UL, 0x0020C49CUL, 0x000346DDUL,
+    0x000053E3UL, 0x00000864UL, 0x000000D7UL, 0x00000016UL, 0x00000003UL};
+
+// Prints intPart.frac with digits decimals, frac being a 32 bit binary
+// fraction (frac / 2^32). Only 32 bit integer math, no float library.
+static uint8_t printFixed(__data writefunc_p writefunc,
+                          __xdata uint32_t intPart, __xdata uint32_t frac,
+                          __xdata uint8_t digits) {
   __xdata uint8_t n = 0;
-  __xdata uint8_t i;
-  __xdata unsigned long int_part;
-  __xdata double remainder, rounding;
-  __xdata unsigned int toPrint;
-
-  if (isnan(number))
-    return printStr(writefunc, "nan");
-  if (isinf(number))
-    return printStr(writefunc, "inf");
-  if (number > 4294967040.0)
-    return printStr(writefunc, "ovf"); // constant determined empirically
-  if (number < -4294967040.0)
-    return printStr(writefunc, "ovf"); // constant determined empirically
-
-  // Handle negative numbers
-  if (number < 0.0) {
-    n += writefunc('-');
-    number = -number;
-  }
+  __xdata uint8_t i = 0;
+  __xdata char buf[12];
+  __data uint32_t x8, sum;
+  __data uint8_t digit;
 
   // Round correctly so that print(1.999, 2) prints as "2.00"
-  rounding = 0.5;
-  for (i = 0; i < digits; ++i)
-    rounding /= 10.0;
-
-  number += rounding;
+  if (digits < sizeof(printRounding) / sizeof(printRounding[0])) {
+    sum = frac + printRounding[digits];
+    if (sum < frac)
+      intPart++;
+    frac = sum;
+  }
 
-  // Extract the integer part of the number and print it
-  int_part = (unsigned long)number;
-  remainder = number - (double)int_part;
-  n += printNumber(writefunc, int_part, 10);
+  n += printNumber(writefunc, intPart, 10);
 
   // Print the decimal point, but only if there are digits beyond
   if (digits > 0) {
     n += writefunc('.');
   }
 
-  // Extract digits from the remainder one at a time
+  // frac * 10 = frac * 8 + frac * 2, the part above 32 bits is the next digit
   while (digits-- > 0) {
-    remainder *= 10.0;
-    toPrint = (unsigned int)(remainder);
-    n += printNumber(writefunc, toPrint, 10);
-    remainder -= toPrint;
+    x8 = frac << 3;
+    sum = x8 + (frac << 1);
+    digit = (uint8_t)(frac >> 29) + (uint8_t)(frac >> 31) + (sum < x8);
+    frac = sum;
+    buf[i++] = '0' + digit;
+    if (i == sizeof(buf) - 1 || digits == 0) {
+      buf[i] = '\0';
+      n += printStr(writefunc, buf);
+      i = 0;
+    }
   }
 
   return n;
 }
+
+uint8_t Print_print_fd(__data writefunc_p writefunc, __xdata double number,
+                       __xdata uint8_t digits) {
+  // the IEEE-754 bits of the float, double is float on SDCC
+  __xdata union {
+    float f;
+    uint32_t bits;
+  } value;
+  __xdata uint8_t n = 0;
+  __xdata uint8_t exponent;
+  __xdata uint8_t shift;
+  __xdata uint32_t mantissa;
+  __xdata uint32_t intPart = 0;
+  __xdata uint32_t frac = 0;
+
+  value.f = number;
+  exponent = value.bits >> 23;
+  mantissa = value.bits & 0x7FFFFFUL;
+
+  if (exponent == 0xFF)
+    return printStr(writefunc, mantissa ? "nan" : "inf");
+  // 2^32 and above does not fit the integer part. The largest float below
+  // is 4294967040, the constant the float version found empirically.
+  if (exponent >= 127 + 32)
+    return printStr(writefunc, "ovf");
+
+  // Handle negative numbers
+  if ((value.bits & 0x80000000UL) && (value.bits & 0x7FFFFFFFUL)) {
+    n += writefunc('-');
+  }
+
+  // number = mantissa * 2^(exponent - 150), with the hidden bit
+  if (exponent) {
+    mantissa |= 0x800000UL;
+  } else {
+    exponent = 1; // denormal
+  }
+  if (exponent >= 150) {
+    intPart = mantissa << (exponent - 150);
+  } else {
+    shift = 150 - exponent;
+    if (shift < 32) {
+      intPart = mantissa >> shift;
+      frac = mantissa << (32 - shift);
+    } else if (shift < 32 + 24) {
+      frac = mantissa >> (shift - 32);
+    }
+  }
+
+  return n + printFixed(writefunc, intPart, frac, digits);
+}
+
+uint8_t Print_print_q(__data writefunc_p writefunc, __xdata long number,
+                      __xdata uint8_t fracBits, __xdata uint8_t digits) {
+  __xdata uint8_t n = 0;
+  __xdata uint32_t magnitude = number;
+
+  if (number < 0) {
+    n += writefunc('-');
+    magnitude = -magnitude;
+  }
+  if (fracBits == 0)
+    return n + printFixed(writefunc, magnitude, 0, digits);
+  if (fracBits > 31)
+    fracBits = 31;
+  return n + printFixed(writefunc, magnitude >> fracBits,
+                        magnitude << (32 - fracBits), digits);
+}
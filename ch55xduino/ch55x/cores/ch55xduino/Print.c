@@ -51,10 +51,15 @@ uint8_t Print_print_sn(__data writefunc_p writefunc, uint8_t *__xdata buffer,
 uint8_t Print_print_s(__data writefunc_p writefunc, char *__xdata str) {
   __data uint8_t n = 0;
   __data char c;
+  __data writefunc_s_p writefunc_s;
 
   if (!str)
     return 0;
 
+  writefunc_s = Print_getStringWrite(writefunc);
+  if (writefunc_s != NULL)
+    return writefunc_s(str);
+
   while (c = *str++) { // assignment intented
     if (writefunc(c))
       n++;
@@ -76,11 +81,50 @@ uint8_t Print_print_i(__data writefunc_p writefunc, __xdata long n) {
 // /////////////////////////////////////////////////////////////
 
 uint8_t Print_println(__data writefunc_p writefunc) {
-  __data uint8_t n;
+  return Print_print_s(writefunc, "\r\n");
+}
 
-  n = writefunc(13);
-  n += writefunc(10);
-  return n;
+// Decimal digits without a 32 bit division per digit, which is a library
+// call on the 8051: each digit is the number of times its power of ten can be
+// subtracted. Below 10000 the rest fits in 16 bits.
+static __code unsigned long printPow10[] = {1000000000UL, 100000000UL,
+                                            10000000UL,   1000000UL,
+                                            100000UL,     10000UL};
+static __code uint16_t printPow10Int[] = {1000, 100, 10};
+
+static void printDecimal(__xdata char *str, __xdata unsigned long n) {
+  __data uint8_t i;
+  __data char c;
+  __data uint16_t m;
+  __bit started = 0;
+
+  if (n >= 10000) {
+    for (i = 0; i < sizeof(printPow10) / sizeof(printPow10[0]); i++) {
+      c = '0';
+      while (n >= printPow10[i]) {
+        n -= printPow10[i];
+        c++;
+      }
+      if (c != '0' || started) {
+        *str++ = c;
+        started = 1;
+      }
+    }
+  }
+  m = n;
+  for (i = 0; i < sizeof(printPow10Int) / sizeof(printPow10Int[0]); i++) {
+    c = '0';
+    while (m >= printPow10Int[i]) {
+      m -= printPow10Int[i];
+      c++;
+    }
+    if (c != '0' || started) {
+      *str++ = c;
+      started = 1;
+    }
+  }
+  *str++ = '0' + m;
+  *str = '\0';
 }
 
 uint8_t Print_print_ub(__data writefunc_p writefunc, __xdata unsigned long n,
@@ -94,6 +138,28 @@ uint8_t Print_print_ub(__data writefunc_p writefunc, __xdata unsigned long n,
   if (base < 2)
     base = 10;
 
+  if (base == 10) {
+    printDecimal(buf, n);
+    return Print_print_s(writefunc, buf);
+  }
+
+  if ((base & (base - 1)) == 0) {
+    // HEX, OCT and BIN: digits are groups of bits
+    __data uint8_t shift = 1;
+    __data uint8_t mask = base - 1;
+
+    while ((uint8_t)(1 << shift) != base)
+      shift++;
+    do {
+      __data char c = n & mask;
+      n >>= shift;
+
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while (n);
+
+    return Print_print_s(writefunc, str);
+  }
+
   do {
     __data char c = n % base;
     n /= base;
@@ -33,6 +33,10 @@
 // for the function pointer to the actual write function
 typedef uint8_t (*writefunc_p)(__data uint8_t c);
 
+// an output's write for a whole zero terminated string, returns the number of
+// characters written. Registered with Print_setStringWrite().
+typedef uint8_t (*writefunc_s_p)(char *str);
+
 // abreviations of the actual function names, mostly for internal use
 #define printBuf Print_print_sn
 #define printStr Print_print_s
@@ -63,6 +67,11 @@ uint8_t Print_print_ub(__data writefunc_p writefunc, __xdata unsigned long n,
 uint8_t Print_print_fd(__data writefunc_p writefunc, __xdata double number,
                        __xdata uint8_t digits);
 #define Print_print_f(W, N) Print_print_fd(W, N, 2)
+
+// print a Q-format fixed point value, number / 2^fracBits, with digits
+// decimals. For example Print_print_q(W, 0x18000, 16, 2) prints "1.50".
+uint8_t Print_print_q(__data writefunc_p writefunc, __xdata long number,
+                      __xdata uint8_t fracBits, __xdata uint8_t digits);
 // inline uint8_t Print_print_f(writefunc_p writefunc, __xdata double number) {
 //   return Print_print_fd(writefunc, number, 2);
 // }
@@ -70,4 +79,9 @@ uint8_t Print_print_fd(__data writefunc_p writefunc, __xdata double number,
 // Variants of the above with a newline added at the and:
 uint8_t Print_println(__data writefunc_p writefunc);
 
+// let Print_print_s() hand whole strings sent to writefunc to writefunc_s
+void Print_setStringWrite(__data writefunc_p writefunc,
+                          __xdata writefunc_s_p writefunc_s);
+writefunc_s_p Print_getStringWrite(__data writefunc_p writefunc);
+
 #endif
@@ -9,10 +9,17 @@
 #include <stdbool.h>
 #include "include/ch5xx.h"
 #include "include/ch5xx_usb.h"
+#include "Print.h"
 // clang-format on
 
 extern __xdata uint8_t Ep0Buffer[];
 extern __xdata uint8_t Ep2Buffer[];
+#ifdef CDC_TX_DOUBLE_BUFFER
+extern __xdata uint8_t Ep3Buffer[];
+#endif
+
+uint8_t USBSerial_write(__data char c);
+uint8_t USBSerial_writeStr(char *str);
 
 #define LINE_CODEING_SIZE 7
 __xdata uint8_t LineCoding[LINE_CODEING_SIZE] = {
@@ -20,21 +27,128 @@ __xdata uint8_t LineCoding[LINE_CODEING_SIZE] = {
     0x00, 0x00, 0x08}; // Initialize for baudrate 57600, 1 stopbit, No parity,
                        // eight data bits
 
+#ifdef USB_CDC_RX_BUFFER_SIZE
+// USB_EP2_OUT copies every packet into this ring, so the endpoint keeps ACKing
+// as long as another full packet fits.
+#if (USB_CDC_RX_BUFFER_SIZE & (USB_CDC_RX_BUFFER_SIZE - 1)) ||                \
+    (USB_CDC_RX_BUFFER_SIZE < 128) || (USB_CDC_RX_BUFFER_SIZE > 512)
+#error "USB_CDC_RX_BUFFER_SIZE must be 128, 256 or 512"
+#endif
+#if USB_CDC_RX_BUFFER_SIZE > 256
+typedef uint16_t usbRxIndex_t;
+#else
+typedef uint8_t usbRxIndex_t;
+#endif
+#define USB_CDC_RX_MASK (USB_CDC_RX_BUFFER_SIZE - 1)
+#define USB_CDC_RX_FREE(head, tail)                                            \
+  (USB_CDC_RX_MASK - (((head) - (tail)) & USB_CDC_RX_MASK))
+
+__xdata uint8_t usbRxBuffer[USB_CDC_RX_BUFFER_SIZE];
+volatile __xdata usbRxIndex_t usbRxHead = 0; // Written by USB_EP2_OUT only
+volatile __xdata usbRxIndex_t usbRxTail = 0; // Written by main code only
+volatile __bit usbRxNakFlag = 0; // Endpoint NAKs until a packet fits again
+#else
 volatile __xdata uint8_t USBByteCountEP2 =
     0; // Bytes of received data on USB endpoint
 volatile __xdata uint8_t USBBufOutPointEP2 = 0; // Data pointer for fetching
+#endif
 
 volatile __bit UpPoint2BusyFlag = 0; // Flag of whether upload pointer is busy
 volatile __xdata uint8_t controlLineState = 0;
 
 __xdata uint8_t usbWritePointer = 0;
+__bit usbTxNeedZLP = 0; // Last packet sent was full size
+
+#ifndef USB_CDC_WRITE_TIMEOUT_MS
+#define USB_CDC_WRITE_TIMEOUT_MS 250
+#endif
+#if USB_CDC_WRITE_TIMEOUT_MS > 300
+#error "USB_CDC_WRITE_TIMEOUT_MS can't be more than 300"
+#endif
+
+#ifdef USB_CDC_AUTO_FLUSH_FRAMES
+#if (USB_CDC_AUTO_FLUSH_FRAMES < 1) || (USB_CDC_AUTO_FLUSH_FRAMES > 255)
+#error "USB_CDC_AUTO_FLUSH_FRAMES must be 1 to 255"
+#endif
+// USB_CDC_SOF sends a partial packet once it is this many frames (ms) old.
+// Main code holds usbTxLock while it touches the packet being filled.
+volatile __bit usbTxLock = 0;
+volatile __xdata uint8_t usbTxAgeFrames = 0;
+#define USB_TX_LOCK() (usbTxLock = 1)
+#define USB_TX_UNLOCK() (usbTxLock = 0)
+#else
+#define USB_TX_LOCK()
+#define USB_TX_UNLOCK()
+#endif
+
+#ifdef CDC_TX_DOUBLE_BUFFER
+// Ep3Buffer holds 2 IN packets. The sketch fills one while the other is in
+// flight. A full packet queued behind the one in flight is handed to the
+// endpoint by USB_EP3_IN, so the host never waits for loop() to come around.
+volatile __bit usbTxQueuedFlag = 0;           // The other packet is queued
+volatile __xdata uint8_t usbTxQueuedLen = 0;  // Length of the queued packet
+volatile __xdata uint8_t usbTxFillOffset = 0; // Packet being filled, 0 or 64
+
+// USBSerial_sendBlock points the endpoint straight at a sketch buffer.
+// USB_EP3_IN moves it on by one packet per IN transaction.
+volatile __bit usbTxBlockFlag = 0;            // A block is being sent
+__xdata uint8_t *__xdata usbTxBlockPtr;       // Next packet of the block
+volatile __xdata uint16_t usbTxBlockLeft = 0; // Bytes after that packet
+
+#define USB_TX_BUF(i) Ep3Buffer[usbTxFillOffset + (i)]
+#define USB_TX_BLOCKED (usbTxQueuedFlag | usbTxBlockFlag)
+
+#if defined(CH559)
+#define SET_UEP3_DMA(addr)                                                     \
+  {                                                                            \
+    UEP3_DMA_H = ((uint16_t)(addr) >> 8);                                      \
+    UEP3_DMA_L = ((uint16_t)(addr) >> 0);                                      \
+  }
+#else
+#define SET_UEP3_DMA(addr) (UEP3_DMA = (uint16_t)(addr))
+#endif
+#else
+#define USB_TX_BUF(i) Ep2Buffer[MAX_PACKET_SIZE + (i)]
+#define USB_TX_BLOCKED UpPoint2BusyFlag
+#endif
 
 void delayMicroseconds(__data uint16_t us);
 
+#ifdef USB_CDC_UART_BRIDGE
+// Serial0 is wired to the CDC endpoints inside the UART and USB interrupts,
+// no byte goes through loop(). The sketch must not use USBSerial or Serial0.
+#if !defined(CDC_TX_DOUBLE_BUFFER) || defined(USB_CDC_RX_BUFFER_SIZE)
+#error "USB_CDC_UART_BRIDGE needs CDC_TX_DOUBLE_BUFFER and no USB RX ring"
+#endif
+void Serial0_begin(__data unsigned long baud);
+void uart0BridgeTxHandler(void);
+
+volatile __bit bridgeLineCodingFlag = 1; // Line coding not applied yet
+volatile __bit bridgeUartBusy = 0;       // SBUF is shifting out a byte
+__bit bridgeNinthBit = 0;         // Mode 3, TB8 is parity or a 2nd stop bit
+__bit bridgeSevenBits = 0;        // Bit 7 is parity or a 2nd stop bit
+__xdata uint8_t bridgeParity = 0; // 0 none, 1 odd, 2 even, 3 mark, 4 space
+volatile __xdata uint16_t bridgeRxDropped = 0; // UART bytes with no room
+#endif
+
 void resetCDCParameters() {
 
+#ifdef USB_CDC_RX_BUFFER_SIZE
+  usbRxHead = 0;
+  usbRxTail = 0;
+  usbRxNakFlag = 0;
+#else
   USBByteCountEP2 = 0; // Bytes of received data on USB endpoint
+#endif
   UpPoint2BusyFlag = 0;
+  usbTxNeedZLP = 0;
+#ifdef USB_CDC_AUTO_FLUSH_FRAMES
+  usbTxAgeFrames = 0;
+#endif
+#ifdef CDC_TX_DOUBLE_BUFFER
+  usbTxQueuedFlag = 0;
+  usbTxBlockFlag = 0;
+#endif
 }
 
 void setLineCodingHandler() {
@@ -44,7 +158,9 @@ void setLineCodingHandler() {
     LineCoding[i] = Ep0Buffer[i];
   }
 
-  //!!!!!Config_Uart0(LineCoding);
+#ifdef USB_CDC_UART_BRIDGE
+  bridgeLineCodingFlag = 1; // applied by USBSerial_bridgePoll, outside the ISR
+#endif
 }
 
 uint16_t getLineCodingHandler() {
@@ -93,16 +209,22 @@ void setControlLineStateHandler() {
   }
 }
 
+// With CDC_TX_DOUBLE_BUFFER only the packet being filled matters, so this
+// waits for the queued packet to reach the endpoint instead.
 uint8_t USBSerial_wait_UpPoint2BusyFlag_clear() {
+#if USB_CDC_WRITE_TIMEOUT_MS == 0
+  return !USB_TX_BLOCKED; // never wait, caller drops the data
+#else
   __data uint16_t waitWriteCount = 0;
-  while (UpPoint2BusyFlag) { // wait for 250ms or give up, on my mac it takes
-                             // about 256us
+  while (USB_TX_BLOCKED) { // wait for 250ms or give up, on my mac it takes
+                           // about 256us
     waitWriteCount++;
     delayMicroseconds(5);
-    if (waitWriteCount >= 50000)
+    if (waitWriteCount >= USB_CDC_WRITE_TIMEOUT_MS * 200U)
       return 0;
   }
   return 1;
+#endif
 }
 
 bool USBSerial() {
@@ -113,40 +235,186 @@ bool USBSerial() {
   return result;
 }
 
-void USBSerial_flush(void) {
-  if (!UpPoint2BusyFlag && usbWritePointer > 0) {
+#ifdef CDC_TX_DOUBLE_BUFFER
+// Send the packet being filled, or queue it behind the one in flight. Returns 0
+// if both packets still belong to the endpoint. Also called from USB_CDC_SOF.
+#pragma save
+#pragma nooverlay
+uint8_t USBSerial_sendPacket() {
+  __data uint8_t accepted = 1;
+  IE_USB = 0; // USB_EP3_IN changes the same state
+  if (USB_TX_BLOCKED) {
+    accepted = 0;
+  } else {
+    if (UpPoint2BusyFlag) {
+      usbTxQueuedLen = usbWritePointer;
+      usbTxQueuedFlag = 1;
+    } else {
+      SET_UEP3_DMA(Ep3Buffer + usbTxFillOffset);
+      UEP3_T_LEN = usbWritePointer;
+      UEP3_CTRL = UEP3_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK; // Respond ACK
+      UpPoint2BusyFlag = 1;
+    }
+    usbTxNeedZLP = (usbWritePointer == MAX_PACKET_SIZE);
+    usbTxFillOffset ^= MAX_PACKET_SIZE;
+    usbWritePointer = 0;
+  }
+  IE_USB = 1;
+  return accepted;
+}
+#pragma restore
+
+void USBSerial_flushPacket(void) {
+  // A transfer ending with a full packet needs an empty packet to end it,
+  // needed for windows. If both packets are busy, the next flush retries.
+  if (usbWritePointer > 0 || usbTxNeedZLP) {
+    USBSerial_sendPacket();
+  }
+}
+
+// Hand the next packet of the block to the endpoint, no copy is made. Also
+// called from USB_EP3_IN.
+#pragma save
+#pragma nooverlay
+void USBSerial_sendBlockPacket() {
+  __data uint8_t len = MAX_PACKET_SIZE;
+  if (usbTxBlockLeft < MAX_PACKET_SIZE)
+    len = usbTxBlockLeft;
+  SET_UEP3_DMA(usbTxBlockPtr);
+  UEP3_T_LEN = len;
+  UEP3_CTRL = UEP3_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK; // Respond ACK
+  usbTxBlockPtr += len;
+  usbTxBlockLeft -= len;
+  usbTxNeedZLP = (len == MAX_PACKET_SIZE);
+}
+#pragma restore
+
+// Send the bytes written before, and the empty packet owed after a full one,
+// and wait until they left the endpoint. Gives up like USBSerial_write().
+static uint8_t USBSerial_drainForBlock(void) {
+#if USB_CDC_WRITE_TIMEOUT_MS > 0
+  __data uint16_t waitWriteCount = 0;
+#endif
+  while (1) {
+    USBSerial_flushPacket();
+    if (!UpPoint2BusyFlag && usbWritePointer == 0 && !usbTxNeedZLP)
+      return 1;
+#if USB_CDC_WRITE_TIMEOUT_MS == 0
+    return 0; // never wait, the caller retries
+#else
+    waitWriteCount++;
+    delayMicroseconds(5);
+    if (waitWriteCount >= USB_CDC_WRITE_TIMEOUT_MS * 200U)
+      return 0;
+#endif
+  }
+}
+
+uint8_t USBSerial_sendBlock(__xdata uint8_t *buf, __xdata uint16_t len) {
+  __data uint8_t started = 0;
+  if (controlLineState == 0 || len == 0 || ((uint16_t)buf & 1))
+    return 0; // the endpoint can only start at an even address
+  USB_TX_LOCK();
+  if (!USBSerial_drainForBlock()) { // bytes already written go first
+    USB_TX_UNLOCK();
+    return 0;
+  }
+  IE_USB = 0;
+  if (!UpPoint2BusyFlag && !usbTxQueuedFlag && !usbTxBlockFlag &&
+      usbWritePointer == 0 && !usbTxNeedZLP) {
+    usbTxBlockPtr = buf;
+    usbTxBlockLeft = len;
+    usbTxBlockFlag = 1;
+    UpPoint2BusyFlag = 1;
+    USBSerial_sendBlockPacket();
+    started = 1;
+  }
+  IE_USB = 1;
+  USB_TX_UNLOCK();
+  return started;
+}
+
+bool USBSerial_blockBusy(void) { return usbTxBlockFlag; }
+#else
+void USBSerial_flushPacket(void) {
+  // A transfer ending with a full packet needs an empty packet to end it,
+  // needed for windows. If the endpoint is busy, the next flush retries.
+  if (!UpPoint2BusyFlag && (usbWritePointer > 0 || usbTxNeedZLP)) {
     UEP2_T_LEN = usbWritePointer;
     UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK; // Respond ACK
     UpPoint2BusyFlag = 1;
+    usbTxNeedZLP = (usbWritePointer == MAX_PACKET_SIZE);
+    usbWritePointer = 0;
+  }
+}
+#endif
+
+void USBSerial_flush(void) {
+  USB_TX_LOCK();
+  USBSerial_flushPacket();
+  USB_TX_UNLOCK();
+}
+
+#ifdef USB_CDC_AUTO_FLUSH_FRAMES
+// Called on every SOF, once per ms
+void USB_CDC_SOF() {
+  if (usbTxLock)
+    return; // main code is filling the packet, try next frame
+  if (usbWritePointer == 0 && !usbTxNeedZLP) {
+    usbTxAgeFrames = 0;
+  } else if (usbTxAgeFrames < USB_CDC_AUTO_FLUSH_FRAMES - 1) {
+    usbTxAgeFrames++;
+  } else {
+    USBSerial_flushPacket(); // if the endpoint is busy, retry next frame
+  }
+}
+#endif
 
-    if (usbWritePointer ==
-        MAX_PACKET_SIZE) { // write empty packet for end transmission. Needed
-                           // for windows.
-      if (USBSerial_wait_UpPoint2BusyFlag_clear()) {
-        UEP2_T_LEN = 0;
-        UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK; // Respond ACK
-        UpPoint2BusyFlag = 1;
+uint8_t USBSerial_availableForWrite(void) {
+  if (controlLineState == 0 || USB_TX_BLOCKED)
+    return 0;
+  return MAX_PACKET_SIZE - usbWritePointer;
+}
+
+uint8_t USBSerial_tryWrite(uint8_t *__xdata buf, __xdata uint8_t len) {
+  __data uint8_t count = 0;
+  if (controlLineState > 0) {
+    USB_TX_LOCK();
+    while (count < len) {
+      if (USB_TX_BLOCKED)
+        break;
+      if (usbWritePointer < MAX_PACKET_SIZE) {
+        USB_TX_BUF(usbWritePointer) = *buf++;
+        usbWritePointer++;
+        count++;
+      } else {
+        USBSerial_flushPacket(); // never waits
       }
     }
-    usbWritePointer = 0;
+    USB_TX_UNLOCK();
   }
+  return count;
 }
 
 uint8_t USBSerial_write(__data char c) { // 3 bytes generic pointer
+  __data uint8_t written = 0;
   if (controlLineState > 0) {
+    USB_TX_LOCK();
     while (true) {
       if (USBSerial_wait_UpPoint2BusyFlag_clear() == 0)
-        return 0;
+        break;
       if (usbWritePointer < MAX_PACKET_SIZE) {
-        Ep2Buffer[MAX_PACKET_SIZE + usbWritePointer] = c;
+        USB_TX_BUF(usbWritePointer) = c;
         usbWritePointer++;
-        return 1;
+        written = 1;
+        break;
       } else {
-        USBSerial_flush(); // go back to first while
+        USBSerial_flushPacket(); // go back to first while
       }
     }
+    USB_TX_UNLOCK();
   }
-  return 0;
+  return written;
 }
 
 uint8_t
@@ -154,24 +422,108 @@ USBSerial_print_n(uint8_t *__xdata buf,
                   __xdata int len) { // 3 bytes generic pointer, not using
                                      // USBSerial_write for a bit efficiency
   if (controlLineState > 0) {
+    USB_TX_LOCK();
     while (len > 0) {
       if (USBSerial_wait_UpPoint2BusyFlag_clear() == 0)
-        return 0;
+        break;
       while (len > 0) {
         if (usbWritePointer < MAX_PACKET_SIZE) {
-          Ep2Buffer[MAX_PACKET_SIZE + usbWritePointer] = *buf++;
+          USB_TX_BUF(usbWritePointer) = *buf++;
           usbWritePointer++;
           len--;
         } else {
-          USBSerial_flush(); // go back to first while
+          USBSerial_flushPacket(); // go back to first while
           break;
         }
       }
     }
+    USB_TX_UNLOCK();
   }
   return 0;
 }
 
+// Like USBSerial_print_n, for a zero terminated string, and returns the count.
+// Print_print_s() uses it for USB serial, init() registers it.
+uint8_t USBSerial_writeStr(char *str) {
+  __data uint8_t count = 0;
+  __data char c = *str;
+  if (controlLineState > 0) {
+    USB_TX_LOCK();
+    while (c) {
+      if (USBSerial_wait_UpPoint2BusyFlag_clear() == 0)
+        break;
+      while (c) {
+        if (usbWritePointer < MAX_PACKET_SIZE) {
+          USB_TX_BUF(usbWritePointer) = c;
+          usbWritePointer++;
+          count++;
+          c = *++str;
+        } else {
+          USBSerial_flushPacket(); // go back to first while
+          break;
+        }
+      }
+    }
+    USB_TX_UNLOCK();
+  }
+  return count;
+}
+
+#ifdef USB_CDC_RX_BUFFER_SIZE
+// Indexes may be 16 bit, so they are only touched with USB interrupt off.
+uint8_t USBSerial_available() {
+  __data usbRxIndex_t count;
+  IE_USB = 0;
+  count = (usbRxHead - usbRxTail) & USB_CDC_RX_MASK;
+  IE_USB = 1;
+#if USB_CDC_RX_BUFFER_SIZE > 256
+  if (count > 255)
+    return 255;
+#endif
+  return count;
+}
+
+void USBSerial_releaseRx(__data usbRxIndex_t tail) {
+  IE_USB = 0;
+  usbRxTail = tail;
+  // head doesn't move while the endpoint NAKs
+  if (usbRxNakFlag && USB_CDC_RX_FREE(usbRxHead, tail) >= MAX_PACKET_SIZE) {
+    usbRxNakFlag = 0;
+    UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_ACK;
+  }
+  IE_USB = 1;
+}
+
+char USBSerial_read() {
+  __data usbRxIndex_t head;
+  __data usbRxIndex_t tail = usbRxTail;
+  IE_USB = 0;
+  head = usbRxHead;
+  IE_USB = 1;
+  if (head == tail)
+    return 0;
+  __data char data = usbRxBuffer[tail];
+  USBSerial_releaseRx((tail + 1) & USB_CDC_RX_MASK);
+  return data;
+}
+
+uint8_t USBSerial_readBytes(uint8_t *__xdata buf, __xdata uint8_t len) {
+  __data uint8_t count = 0;
+  __data usbRxIndex_t head;
+  __data usbRxIndex_t tail = usbRxTail;
+  IE_USB = 0;
+  head = usbRxHead;
+  IE_USB = 1;
+  while (count < len && head != tail) {
+    *buf++ = usbRxBuffer[tail];
+    tail = (tail + 1) & USB_CDC_RX_MASK;
+    count++;
+  }
+  if (count)
+    USBSerial_releaseRx(tail);
+  return count;
+}
+#else
 uint8_t USBSerial_available() { return USBByteCountEP2; }
 
 char USBSerial_read() {
@@ -186,13 +538,72 @@ char USBSerial_read() {
   return data;
 }
 
+uint8_t USBSerial_readBytes(uint8_t *__xdata buf, __xdata uint8_t len) {
+  __data uint8_t count = 0;
+  while (count < len && USBByteCountEP2) {
+    *buf++ = USBSerial_read();
+    count++;
+  }
+  return count;
+}
+#endif
+
+#ifndef CDC_TX_DOUBLE_BUFFER
 void USB_EP2_IN() {
   UEP2_T_LEN = 0; // No data to send anymore
   UEP2_CTRL =
       UEP2_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK; // Respond NAK by default
   UpPoint2BusyFlag = 0;                            // Clear busy flag
 }
+#else
+void USB_EP3_IN() {
+  if (usbTxBlockFlag && usbTxBlockLeft) {
+    USBSerial_sendBlockPacket(); // keep ACK and busy flag
+  } else if (usbTxBlockFlag) {
+    usbTxBlockFlag = 0; // the sketch may reuse the buffer now, a ZLP owed by
+                        // a full last packet is sent by the next flush
+    UEP3_T_LEN = 0;
+    UEP3_CTRL = UEP3_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK;
+    UpPoint2BusyFlag = 0;
+  } else if (usbTxQueuedFlag) {
+    // The queued packet is the one not being filled. Keep ACK and busy flag.
+    SET_UEP3_DMA(Ep3Buffer + (usbTxFillOffset ^ MAX_PACKET_SIZE));
+    UEP3_T_LEN = usbTxQueuedLen;
+    UEP3_CTRL = UEP3_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK;
+    usbTxQueuedFlag = 0;
+  } else {
+    UEP3_T_LEN = 0; // No data to send anymore
+    UEP3_CTRL =
+        UEP3_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK; // Respond NAK by default
+    UpPoint2BusyFlag = 0;                            // Clear busy flag
+#ifdef USB_CDC_UART_BRIDGE
+    // send what the UART received while the last packet was in flight
+    if (usbWritePointer > 0 || usbTxNeedZLP)
+      USBSerial_sendPacket();
+#endif
+  }
+}
+#endif
 
+#ifdef USB_CDC_RX_BUFFER_SIZE
+void USB_EP2_OUT() {
+  if (U_TOG_OK) // Discard unsynchronized packets
+  {
+    __data uint8_t len = USB_RX_LEN;
+    __data usbRxIndex_t head = usbRxHead;
+    for (__data uint8_t i = 0; i < len; i++) {
+      usbRxBuffer[head] = Ep2Buffer[i];
+      head = (head + 1) & USB_CDC_RX_MASK;
+    }
+    usbRxHead = head;
+    if (USB_CDC_RX_FREE(head, usbRxTail) < MAX_PACKET_SIZE) {
+      UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_R_RES |
+                  UEP_R_RES_NAK; // Respond NAK until main code reads enough
+      usbRxNakFlag = 1;
+    }
+  }
+}
+#else
 void USB_EP2_OUT() {
   if (U_TOG_OK) // Discard unsynchronized packets
   {
@@ -202,7 +613,139 @@ void USB_EP2_OUT() {
       UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_R_RES |
                   UEP_R_RES_NAK; // Respond NAK after a packet. Let main code
                                  // change response after handling.
+#ifdef USB_CDC_UART_BRIDGE
+    if (!bridgeUartBusy)
+      uart0BridgeTxHandler();
+#endif
+  }
+}
+#endif
+
+#ifdef USB_CDC_UART_BRIDGE
+// Timer1 gives F_CPU / 16 / x baud for x of 1 to 256 (see Serial0_begin).
+// 0 and rates it cannot make within about 3% are refused.
+static __bit bridgeBaudValid(__data uint32_t baud) {
+  __data uint32_t x;
+  __data uint32_t rate;
+
+  if (baud == 0) {
+    return 0;
+  }
+  x = (F_CPU / 16 + baud / 2) / baud;
+  if (x == 0 || x > 256) {
+    return 0;
+  }
+  rate = F_CPU / 16 / x;
+  return (rate > baud ? rate - baud : baud - rate) <= baud / 32;
+}
+
+// LineCoding holds baud rate (4 bytes), stop bits (0: 1, 1: 1.5, 2: 2),
+// parity and data bits. 8 data bits with parity or 2 stop bits use the 9th
+// bit of UART mode 3. With 7 data bits, bit 7 carries it instead. A line
+// coding with a baud rate the UART cannot make is ignored, the UART keeps its
+// current setting.
+void USBSerial_bridgePoll(void) {
+  if (!bridgeLineCodingFlag)
+    return;
+  IE_USB = 0;
+  bridgeLineCodingFlag = 0;
+  if (!bridgeBaudValid(*((__xdata uint32_t *)LineCoding))) {
+    IE_USB = 1;
+    return;
+  }
+  ES = 0;
+  Serial0_begin(*((__xdata uint32_t *)LineCoding));
+  ES = 0;
+  bridgeParity = LineCoding[5];
+  bridgeSevenBits = (LineCoding[6] == 7);
+  bridgeNinthBit =
+      !bridgeSevenBits && ((bridgeParity != 0) || (LineCoding[4] != 0));
+  if (bridgeNinthBit)
+    SM0 = 1; // mode 3 uses the same baud rate as mode 1
+  // a byte cut short by the change is lost, restart sending
+  TI = 0;
+  bridgeUartBusy = 0;
+  uart0BridgeTxHandler();
+  ES = 1;
+  IE_USB = 1;
+}
+
+uint16_t USBSerial_bridgeDropped(void) {
+  __data uint16_t count;
+  __bit serialOn = ES;
+  ES = 0;
+  count = bridgeRxDropped;
+  ES = serialOn;
+  return count;
+}
+
+// The rest runs in the UART0 and USB interrupts
+#pragma save
+#pragma nooverlay
+
+// 1 if c has an odd number of bits set
+__bit bridgeOddBits(__data uint8_t c) {
+  c ^= c >> 4;
+  c ^= c >> 2;
+  c ^= c >> 1;
+  return c & 1;
+}
+
+__bit bridgeParityBit(__data uint8_t c) {
+  switch (bridgeParity) {
+  case 1:
+    return !bridgeOddBits(c);
+  case 2:
+    return bridgeOddBits(c);
+  case 4:
+    return 0;
+  default:
+    return 1; // mark parity, or a stop bit
+  }
+}
+
+// Called when SBUF is free. The last byte of a packet re-enables the
+// endpoint, so the next packet arrives while it is still shifting out.
+void uart0BridgeTxHandler(void) {
+  __data uint8_t c;
+  if (USBByteCountEP2 == 0) {
+    bridgeUartBusy = 0;
+    return;
   }
+  c = Ep2Buffer[USBBufOutPointEP2];
+  USBBufOutPointEP2++;
+  USBByteCountEP2--;
+  if (USBByteCountEP2 == 0)
+    UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_ACK;
+  if (bridgeSevenBits) {
+    c &= 0x7F;
+    if (bridgeParityBit(c))
+      c |= 0x80;
+  } else if (bridgeNinthBit) {
+    TB8 = bridgeParityBit(c);
+  }
+  bridgeUartBusy = 1;
+  SBUF = c;
 }
 
+// Received bytes go straight into the IN packet being filled. The packet is
+// sent at once if the endpoint is idle, otherwise when the one in flight
+// completes. Bytes are lost only when both packets are full, they are
+// counted in bridgeRxDropped.
+void uart0BridgeRxHandler(void) {
+  __data uint8_t c = SBUF;
+  if (bridgeSevenBits)
+    c &= 0x7F;
+  if (!USB_TX_BLOCKED && usbWritePointer < MAX_PACKET_SIZE) {
+    USB_TX_BUF(usbWritePointer) = c;
+    usbWritePointer++;
+  } else {
+    bridgeRxDropped++;
+  }
+  if (!UpPoint2BusyFlag || usbWritePointer == MAX_PACKET_SIZE)
+    USBSerial_sendPacket();
+}
+#pragma restore
+#endif
+
 #endif
@@ -19,7 +19,11 @@
 
 #define CDC_NOTIFICATION_EPADDR 0x81
 #define CDC_NOTIFICATION_EPSIZE 0x08
+#ifdef CDC_TX_DOUBLE_BUFFER
+#define CDC_TX_EPADDR 0x83 // endpoint 3 is TX only, so its DMA can be moved
+#else
 #define CDC_TX_EPADDR 0x82
+#endif
 #define CDC_RX_EPADDR 0x02
 #define CDC_TXRX_EPSIZE 0x40
 
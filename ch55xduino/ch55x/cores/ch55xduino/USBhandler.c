@@ -15,11 +15,18 @@ uint16_t getLineCodingHandler();
 void setControlLineStateHandler();
 void USB_EP2_IN();
 void USB_EP2_OUT();
+void USB_EP3_IN();
+void USB_CDC_SOF();
 
 // clang-format off
 __xdata __at (EP0_ADDR) uint8_t Ep0Buffer[8];
 __xdata __at (EP1_ADDR) uint8_t Ep1Buffer[8];       //on page 47 of data sheet, the receive buffer need to be min(possible packet size+2,64)
+#ifdef CDC_TX_DOUBLE_BUFFER
+__xdata __at (EP2_ADDR) uint8_t Ep2Buffer[64];      //OUT buffer, must be even address
+__xdata __at (EP3_ADDR) uint8_t Ep3Buffer[128];     //2 IN buffers used in turn, must be even address
+#else
 __xdata __at (EP2_ADDR) uint8_t Ep2Buffer[128];     //IN and OUT buffer, must be even address
+#endif
 // clang-format on
 
 __data uint16_t SetupLen;
@@ -82,12 +89,12 @@ void USB_EP0_SETUP() {
       case USB_GET_DESCRIPTOR:
         switch (UsbSetupBuf->wValueH) {
         case 1: // Device Descriptor
-          pDescr = (__code uint8_t *)
-              DeviceDescriptor; // Put Device Descriptor into outgoing buffer
+          // Put Device Descriptor into outgoing buffer
+          pDescr = (__code uint8_t *)&DeviceDescriptor;
           len = sizeof(USB_Descriptor_Device_t);
           break;
         case 2: // Configure Descriptor
-          pDescr = (__code uint8_t *)ConfigurationDescriptor;
+          pDescr = (__code uint8_t *)&ConfigurationDescriptor;
           len = sizeof(USB_Descriptor_Configuration_t);
           break;
         case 3:
@@ -462,6 +469,9 @@ void USBInterrupt(void) { // inline not really working in multiple files in SDCC
     UEP2_CTRL = bUEP_AUTO_TOG | UEP_T_RES_NAK |
                 UEP_R_RES_ACK; // Endpoint 2 automatically flips the sync flag,
                                // IN transaction returns NAK, OUT returns ACK
+#ifdef CDC_TX_DOUBLE_BUFFER
+    UEP3_CTRL = bUEP_AUTO_TOG | UEP_T_RES_NAK;
+#endif
     // UEP4_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;  //bUEP_AUTO_TOG only work for
     // endpoint 1,2,3
 
@@ -520,9 +530,12 @@ void USBDeviceIntCfg() {
   USB_INT_EN |= bUIE_SUSPEND;  // Enable device hang interrupt
   USB_INT_EN |= bUIE_TRANSFER; // Enable USB transfer completion interrupt
   USB_INT_EN |= bUIE_BUS_RST;  // Enable device mode USB bus reset interrupt
-  USB_INT_FG |= 0x1F;          // Clear interrupt flag
-  IE_USB = 1;                  // Enable USB interrupt
-  EA = 1;                      // Enable global interrupts
+#ifdef USB_CDC_AUTO_FLUSH_FRAMES
+  USB_INT_EN |= bUIE_DEV_SOF; // Enable SOF interrupt, CDC auto flush runs on it
+#endif
+  USB_INT_FG |= 0x1F; // Clear interrupt flag
+  IE_USB = 1;         // Enable USB interrupt
+  EA = 1;             // Enable global interrupts
 }
 
 void USBDeviceEndPointCfg() {
@@ -534,13 +547,25 @@ void USBDeviceEndPointCfg() {
   UEP1_DMA_L = ((uint16_t)Ep1Buffer >> 0); // Endpoint 1 data transfer address
   UEP2_DMA_H = ((uint16_t)Ep2Buffer >> 8); // Endpoint 2 data transfer address
   UEP2_DMA_L = ((uint16_t)Ep2Buffer >> 0); // Endpoint 2 data transfer address
+#ifdef CDC_TX_DOUBLE_BUFFER
+  UEP3_DMA_H = ((uint16_t)Ep3Buffer >> 8); // Endpoint 3 data transfer address
+  UEP3_DMA_L = ((uint16_t)Ep3Buffer >> 0); // Endpoint 3 data transfer address
+#endif
 #else
   UEP0_DMA = (uint16_t)Ep0Buffer; // Endpoint 0 data transfer address
   UEP1_DMA = (uint16_t)Ep1Buffer; // Endpoint 1 data transfer address
   UEP2_DMA = (uint16_t)Ep2Buffer; // Endpoint 2 data transfer address
+#ifdef CDC_TX_DOUBLE_BUFFER
+  UEP3_DMA = (uint16_t)Ep3Buffer; // Endpoint 3 data transfer address
+#endif
 #endif
 
+#ifdef CDC_TX_DOUBLE_BUFFER
+  UEP2_3_MOD = bUEP2_RX_EN | bUEP3_TX_EN; // Endpoint2 OUT, Endpoint3 IN
+  UEP3_CTRL = bUEP_AUTO_TOG | UEP_T_RES_NAK;
+#else
   UEP2_3_MOD = 0x0C; // Endpoint2 double buffer
+#endif
   UEP1_CTRL =
       bUEP_AUTO_TOG | UEP_T_RES_NAK; // Endpoint 1 automatically flips the sync
                                      // flag, and IN transaction returns NAK
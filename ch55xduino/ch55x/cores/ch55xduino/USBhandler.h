@@ -13,6 +13,9 @@
 extern __xdata __at (EP0_ADDR) uint8_t Ep0Buffer[];
 extern __xdata __at (EP1_ADDR) uint8_t Ep1Buffer[];
 extern __xdata __at (EP2_ADDR) uint8_t Ep2Buffer[];
+#ifdef CDC_TX_DOUBLE_BUFFER
+extern __xdata __at (EP3_ADDR) uint8_t Ep3Buffer[];
+#endif
 // clang-format on
 
 extern __data uint16_t SetupLen;
@@ -30,7 +33,11 @@ extern const __code uint8_t *__data pDescr;
 #define EP4_OUT_Callback NOP_Process
 
 // SOF
+#ifdef USB_CDC_AUTO_FLUSH_FRAMES
+#define EP0_SOF_Callback USB_CDC_SOF
+#else
 #define EP0_SOF_Callback NOP_Process
+#endif
 #define EP1_SOF_Callback NOP_Process
 #define EP2_SOF_Callback NOP_Process
 #define EP3_SOF_Callback NOP_Process
@@ -39,8 +46,13 @@ extern const __code uint8_t *__data pDescr;
 // IN
 #define EP0_IN_Callback USB_EP0_IN
 #define EP1_IN_Callback USB_EP1_IN
+#ifdef CDC_TX_DOUBLE_BUFFER
+#define EP2_IN_Callback NOP_Process
+#define EP3_IN_Callback USB_EP3_IN
+#else
 #define EP2_IN_Callback USB_EP2_IN
 #define EP3_IN_Callback NOP_Process
+#endif
 #define EP4_IN_Callback NOP_Process
 
 // SETUP
@@ -0,0 +1,651 @@
+#!/usr/bin/python
+
+# Generates wiring_timing.h, the micros() and millis() scaling code and the
+# delayMicroseconds() loop for every F_CPU, from the clock table below.
+#
+#   python generateTiming.py           write wiring_timing.h
+#   python generateTiming.py --check   leave it alone, fail if it is not what
+#                                      this script writes, and run every
+#                                      variant on a small 8051 model
+#
+# Timer0 counts F_CPU/12. In the default mode it reloads every T0_CYCLE ticks
+# and Timer0Interrupt counts overflows in a 5 byte counter m. micros() hands
+# the scaling code m in r0~r4 and TL0 in r5, millis() hands over m in r0~r4.
+# Both return in dpl, dph, b, a.
+
+import os
+import random
+import sys
+from fractions import Fraction
+
+# F_CPU, T0_CYCLE. T0_CYCLE is picked so one overflow is a whole number of
+# ticks and a simple fraction of a microsecond.
+CLOCKS = (
+    (56000000, 224),
+    (48000000, 250),
+    (32000000, 250),
+    (24000000, 250),
+    (16000000, 250),
+    (12000000, 250),
+    (6000000, 250),
+    (3000000, 250),
+    (750000, 250),
+    (187500, 250),
+)
+
+scriptPath = os.path.dirname(os.path.realpath(__file__))
+
+
+def is_pow2(x):
+    return x & (x - 1) == 0
+
+
+def log2(x):
+    return x.bit_length() - 1
+
+
+class Asm:
+    def __init__(self):
+        self.lines = []
+
+    def op(self, text):
+        self.lines.append("    " + text)
+
+    def note(self, text):
+        self.lines.append(";" + text)
+
+    def label(self, text):
+        self.lines.append(text)
+
+    def macro(self, name):
+        out = "#define " + name + " \\\n"
+        body = ['  "' + line.ljust(45) + '\\n"' for line in self.lines]
+        return out + " \\\n".join(body) + "\n"
+
+
+def mul8_forward(asm, regs, k):
+    # regs (low byte first) = regs * k, k < 256, top carry dropped
+    if k == 1:
+        return
+    carry = "r6"
+    for i, reg in enumerate(regs):
+        asm.op("mov b, #%d" % k)
+        asm.op("mov a, %s" % reg)
+        asm.op("mul ab")
+        if i == 0:
+            asm.op("mov %s, a" % reg)
+            asm.op("mov %s, b" % carry)
+        elif i == len(regs) - 1:
+            asm.op("add a, %s" % carry)
+            asm.op("mov %s, a" % reg)
+        else:
+            asm.op("add a, %s" % carry)
+            asm.op("mov %s, a" % reg)
+            asm.op("clr a")
+            asm.op("addc a, b")
+            asm.op("mov %s, a" % carry)
+
+
+def add_from(asm, regs, pos, first, second=None):
+    # regs[pos] += first, regs[pos+1] += second and the carry, carry ripples up
+    # to the last register and is dropped there
+    if pos >= len(regs):
+        return
+    if first != "a":
+        asm.op("mov a, %s" % first)
+    asm.op("add a, %s" % regs[pos])
+    asm.op("mov %s, a" % regs[pos])
+    for i in range(pos + 1, len(regs)):
+        if i == pos + 1 and second is not None:
+            asm.op("mov a, %s" % second)
+        else:
+            asm.op("clr a")
+        asm.op("addc a, %s" % regs[i])
+        asm.op("mov %s, a" % regs[i])
+
+
+def mul16_rows(asm, regs, k):
+    # regs (low byte first) = regs * k, 256 <= k < 65536, top carry dropped.
+    # Rows go from the top byte down, so every row only adds into bytes above
+    # it and m never needs a copy.
+    kl, kh = k & 0xFF, k >> 8
+    n = len(regs)
+    for i in range(n - 1, -1, -1):
+        if i + 1 < n:
+            asm.op("mov a, %s" % regs[i])
+            if kh != 1:
+                asm.op("mov b, #%d" % kh)
+                asm.op("mul ab")
+                add_from(asm, regs, i + 1, "a", "b" if i + 2 < n else None)
+            else:
+                add_from(asm, regs, i + 1, "a")
+        if kl == 0:
+            asm.op("mov %s, #0" % regs[i])
+        elif kl == 1:
+            pass
+        else:
+            asm.op("mov b, #%d" % kl)
+            asm.op("mov a, %s" % regs[i])
+            asm.op("mul ab")
+            asm.op("mov %s, a" % regs[i])
+            if i + 1 < n:
+                add_from(asm, regs, i + 1, "b")
+
+
+def mul_const(asm, regs, k):
+    if k < 256:
+        mul8_forward(asm, regs, k)
+    else:
+        mul16_rows(asm, regs, k)
+
+
+def shift_right(asm, regs, count):
+    for _ in range(count):
+        asm.op("clr c")
+        for reg in reversed(regs):
+            asm.op("mov a, %s" % reg)
+            asm.op("rrc a")
+            asm.op("mov %s, a" % reg)
+
+
+def tick_part(asm, ratio, t_max):
+    # r5 = t, leaves floor(t * ratio) in r5 (low) and r7 (high, if needed)
+    p, q = ratio.numerator, ratio.denominator
+    high = (t_max * p // q) > 255
+    if q == 1 or is_pow2(q):
+        if p != 1:
+            asm.op("mov b, #%d" % p)
+            asm.op("mov a, r5")
+            asm.op("mul ab")
+            asm.op("mov r5, a")
+            asm.op("mov r7, b")
+        elif high:
+            asm.op("mov r7, #0")
+        if q > 1:
+            for _ in range(log2(q)):
+                asm.op("clr c")
+                if p != 1:
+                    asm.op("mov a, r7")
+                    asm.op("rrc a")
+                    asm.op("mov r7, a")
+                asm.op("mov a, r5")
+                asm.op("rrc a")
+                asm.op("mov r5, a")
+    else:
+        assert (q - 1) * p < 256
+        asm.op("mov a, r5")
+        asm.op("mov b, #%d" % q)
+        asm.op("div ab")
+        asm.op("mov r6, b")
+        asm.op("mov b, #%d" % p)
+        asm.op("mul ab")
+        asm.op("mov r5, a")
+        if high:
+            asm.op("mov r7, b")
+        asm.op("mov a, r6")
+        asm.op("mov b, #%d" % p)
+        asm.op("mul ab")
+        asm.op("mov b, #%d" % q)
+        asm.op("div ab")
+        asm.op("add a, r5")
+        asm.op("mov r5, a")
+        if high:
+            asm.op("clr a")
+            asm.op("addc a, r7")
+            asm.op("mov r7, a")
+    return high
+
+
+def ret_regs(asm, regs):
+    asm.op("mov dpl, %s" % regs[0])
+    asm.op("mov dph, %s" % regs[1])
+    asm.op("mov b, %s" % regs[2])
+    asm.op("mov a, %s" % regs[3])
+
+
+def micros_variant(f_cpu, t0_cycle, drop_byte):
+    # (m*m_mul + floor(t*t_ratio)) >> shift, the shift done either with rrc
+    # or by scaling both up to a shift of 8 and dropping the low byte
+    tick = Fraction(12000000, f_cpu)
+    overflow = tick * t0_cycle
+    shift = 0
+    while (overflow * 2 ** shift).denominator != 1:
+        shift += 1
+    if drop_byte:
+        if shift == 0:
+            return None
+        shift = 8
+    m_mul = int(overflow * 2 ** shift)
+    t_ratio = tick * 2 ** shift
+    if m_mul > 0xFFFF or t_ratio.numerator > 255:
+        return None
+    regs = ["r0", "r1", "r2", "r3", "r4"][: 5 if shift else 4]
+
+    asm = Asm()
+    asm.note("1m = %dt 1t=%sus, return (m*%d+t*%s)%s" %
+             (t0_cycle, tick, m_mul, t_ratio,
+              ">>%d" % shift if shift else ""))
+    asm.note("TL0 runs from %d to 255, t=TL0-%d" %
+             (256 - t0_cycle, 256 - t0_cycle))
+    asm.op("clr c")
+    asm.op("mov a, r5")
+    asm.op("subb a, #%d" % (256 - t0_cycle))
+    asm.op("mov r5, a")
+    asm.note("t=t*%s;" % t_ratio)
+    high = tick_part(asm, t_ratio, t0_cycle - 1)
+    asm.note("m=m*%d;" % m_mul)
+    mul_const(asm, regs, m_mul)
+    asm.note("m=m+t;")
+    add_from(asm, regs, 0, "r5", "r7" if high else None)
+    if drop_byte:
+        regs = regs[1:]
+    elif shift:
+        asm.note("m=m>>%d;" % shift)
+        shift_right(asm, regs, shift)
+    asm.note("return")
+    ret_regs(asm, regs)
+    return asm
+
+
+def micros_asm(f_cpu, t0_cycle):
+    variants = [micros_variant(f_cpu, t0_cycle, drop) for drop in (0, 1)]
+    return min((v for v in variants if v), key=lambda v: len(v.lines))
+
+
+def millis_asm(f_cpu, t0_cycle):
+    overflow = Fraction(12 * t0_cycle * 1000, f_cpu)
+    p, q = overflow.numerator, overflow.denominator
+    asm = Asm()
+    if q == 1:
+        asm.note("1m = %sms, return m*%d" % (overflow, p))
+        mul_const(asm, ["r0", "r1", "r2", "r3"], p)
+        ret_regs(asm, ["r0", "r1", "r2", "r3"])
+    elif is_pow2(q) and q <= 256:
+        k = p * 256 // q
+        asm.note("1m = %sms, return (m*%d)>>8" % (overflow, k))
+        regs = ["r0", "r1", "r2", "r3", "r4"]
+        mul_const(asm, regs, k)
+        ret_regs(asm, regs[1:])
+    else:
+        # m*p in r0~r5, then a bit by bit division by q, 48 bit by 8 bit
+        assert p < 256 and q < 128
+        asm.note("1m = %sms, return m*%d/%d" % (overflow, p, q))
+        regs = ["r0", "r1", "r2", "r3", "r4"]
+        for i, reg in enumerate(regs):
+            asm.op("mov b, #%d" % p)
+            asm.op("mov a, %s" % reg)
+            asm.op("mul ab")
+            if i:
+                asm.op("add a, r5")
+            asm.op("mov %s, a" % reg)
+            if i:
+                asm.op("clr a")
+                asm.op("addc a, b")
+                asm.op("mov r5, a")
+            else:
+                asm.op("mov r5, b")
+        asm.op("mov r7, #%d" % q)
+        asm.op("mov a, r5")
+        asm.op("mov b, r7")
+        asm.op("div ab")
+        asm.op("mov r5, b")
+        asm.op("mov b, #40")
+        asm.note("r0~r4=r0~r5/%d, bit by bit" % q)
+        asm.label("1$:")
+        asm.op("clr c")
+        for reg in regs + ["r5"]:
+            asm.op("mov a, %s" % reg)
+            asm.op("rlc a")
+            asm.op("mov %s, a" % reg)
+        asm.op("mov f0, c")
+        asm.op("clr c")
+        asm.op("subb a, r7")
+        asm.note("1 for this bit on shift overflow or non negative subb")
+        asm.op("jb f0, 2$")
+        asm.op("jc 3$")
+        asm.label("2$:")
+        asm.op("mov r5, a")
+        asm.op("inc r0")
+        asm.label("3$:")
+        asm.op("djnz b, 1$")
+        ret_regs(asm, regs)
+    return asm
+
+
+# CH55x cycles, as timed for the old hand written delay loops: branches take
+# 6 cycles to an even address, jc, jnc, jnz and djnz 2 when not taken, cjne
+# 6 either way. Other instructions take one cycle per byte. A call with a constant
+# ("mov dptr, #n" and lcall) takes 9, ret 6.
+CALL_CYCLES = 9
+BYTES = {"nop": 1, "inc": 1, "clr": 1, "rrc": 1, "ret": 1, "jc": 2,
+         "jnc": 2, "jnz": 2, "djnz": 2, "cjne": 3}
+
+
+def op_bytes(op, args):
+    if op in BYTES:
+        return BYTES[op]
+    # mov/add/subb/orl: 1 byte between a and rn, 2 with an immediate or SFR
+    return 1 if all(a == "a" or a.startswith("r") for a in args) else 2
+
+
+def op_cycles(op, args, taken):
+    if op in ("jc", "jnc", "jnz", "djnz"):
+        return 6 if taken else 2
+    if op == "cjne":
+        return 6
+    if op == "ret":
+        return 6
+    return op_bytes(op, args)
+
+
+def delay_unit(f_cpu):
+    # one loop pass waits `unit` us, at least 12 cycles so the loop fits
+    unit = 1
+    while f_cpu * unit % 1000000 or f_cpu * unit // 1000000 < 12:
+        unit *= 2
+    return unit, f_cpu * unit // 1000000
+
+
+def delay_variant(f_cpu, skip, pad):
+    # us in dpl/dph. n = us / unit rounded, then n - skip passes of the loop,
+    # skip passes being the time of the call and setup. pad nops at the end
+    # make up the rest of the fixed time.
+    unit, pass_cycles = delay_unit(f_cpu)
+    asm = Asm()
+    asm.note("1 pass = %dus = %d cycles, %d passes for the call" %
+             (unit, pass_cycles, skip))
+    asm.op(".even")
+    asm.op("mov r6, dpl")
+    asm.op("mov r7, dph")
+    shift = log2(unit)
+    if shift:
+        asm.note("n=(us+%d)>>%d;" % (unit // 2, shift))
+        if shift > 2:
+            asm.op("mov r5, #%d" % shift)
+            asm.label("1$:")
+        for _ in range(1 if shift > 2 else shift):
+            asm.op("clr c")
+            asm.op("mov a, r7")
+            asm.op("rrc a")
+            asm.op("mov r7, a")
+            asm.op("mov a, r6")
+            asm.op("rrc a")
+            asm.op("mov r6, a")
+        if shift > 2:
+            asm.op("djnz r5, 1$")
+        asm.op("addc a, #0")  # a is still r6
+        asm.op("mov r6, a")
+        asm.op("mov a, r7")
+        asm.op("addc a, #0")
+        asm.op("mov r7, a")
+    asm.note("n=n-%d, done if n<=0;" % skip)
+    asm.op("clr c")
+    asm.op("mov a, r6")
+    asm.op("subb a, #%d" % (skip & 0xFF))
+    asm.op("mov r6, a")
+    asm.op("mov a, r7")
+    asm.op("subb a, #%d" % (skip >> 8))
+    asm.op("mov r7, a")
+    asm.op("jnc 2$")
+    asm.op("ret")
+    asm.label("2$:")
+    asm.op("orl a, r6")
+    asm.op("jnz 3$")
+    asm.op("ret")
+    asm.label("3$:")
+    asm.note("djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0")
+    asm.op("mov a, r6")
+    asm.op("add a, #255")
+    asm.op("mov a, r7")
+    asm.op("addc a, #0")
+    asm.op("mov r7, a")
+    if asm_bytes(asm) % 2:
+        asm.op("nop")  # keep the loop at even addresses
+    # the r7 pass skips the 2 nops, its djnz r6 takes 4 cycles less
+    asm.label("4$:")
+    asm.op("nop")
+    asm.op("nop")
+    asm.label("5$:")
+    wait_cycles(asm, pass_cycles - 8, "6$")  # 2 nops and djnz
+    asm.op("djnz r6, 4$")
+    asm.op("djnz r7, 5$")
+    wait_cycles(asm, pad, "7$")
+    return asm
+
+
+def wait_cycles(asm, cycles, label):
+    # nops, or a djnz r5 loop of 6 cycles a pass and nops for the rest
+    if cycles >= 10:
+        loops = (cycles + 2) // 6
+        asm.op("mov r5, #%d" % loops)
+        asm.label(label + ":")
+        asm.op("djnz r5, %s" % label)
+        cycles -= 6 * loops - 2
+    for _ in range(cycles):
+        asm.op("nop")
+
+
+def asm_bytes(asm):
+    total = 0
+    for line in asm.lines:
+        line = line.split(";")[0].strip()
+        if line and not line.endswith(":") and not line.startswith("."):
+            op, _, args = line.partition(" ")
+            total += op_bytes(op, [a.strip() for a in args.split(",") if a])
+    return total
+
+
+def delay_cycles(asm, us):
+    # cycles from the call to the return of delayMicroseconds(us)
+    _, cycles = Mcs51(asm.lines).run({"dpl": us & 0xFF, "dph": us >> 8},
+                                     cycle_count=True)
+    return CALL_CYCLES + cycles + op_cycles("ret", [], False)
+
+
+def delay_asm(f_cpu):
+    unit, pass_cycles = delay_unit(f_cpu)
+    # the fixed time of the call, measured on the loop without correction
+    passes = 1000
+    fixed = delay_cycles(delay_variant(f_cpu, 0, 0), passes * unit) - \
+        passes * pass_cycles
+    skip = -(-fixed // pass_cycles)
+    return delay_variant(f_cpu, skip, skip * pass_cycles - fixed)
+
+
+def low_rate_ratios(f_cpu):
+    # 16 bit mode: 1 tick = us_mul/us_div us = ms_mul/ms_div ms
+    us = Fraction(12000000, f_cpu)
+    ms = us / 1000
+    return us.numerator, us.denominator, ms.numerator, ms.denominator
+
+
+def generate():
+    out = ["// This file is generated by generateTiming.py, do not edit.\n",
+           "#ifndef _WIRING_TIMING_H_INCLUDED\n",
+           "#define _WIRING_TIMING_H_INCLUDED\n\n",
+           "// clang-format off\n"]
+    for index, (f_cpu, t0_cycle) in enumerate(CLOCKS):
+        out.append("%s F_CPU == %d\n" % ("#if" if index == 0 else "#elif",
+                                         f_cpu))
+        out.append("#define T0_CYCLE %d\n" % t0_cycle)
+        for name, value in zip(("T0_US_MUL", "T0_US_DIV", "T0_MS_MUL",
+                                "T0_MS_DIV"), low_rate_ratios(f_cpu)):
+            out.append("#define %s %d\n" % (name, value))
+        out.append(micros_asm(f_cpu, t0_cycle).macro("MICROS_SCALE_ASM"))
+        out.append(millis_asm(f_cpu, t0_cycle).macro("MILLIS_SCALE_ASM"))
+        out.append(delay_asm(f_cpu).macro("DELAY_US_ASM"))
+    out.append("#else\n#error \"clock not supported yet\"\n#endif\n")
+    out.append("// clang-format on\n\n#endif\n")
+    return "".join(out)
+
+
+class Mcs51:
+    # just enough of an 8051 to run the generated code
+
+    def __init__(self, lines):
+        self.code = []
+        self.labels = {}
+        for line in lines:
+            line = line.split(";")[0].strip()
+            if not line or line.startswith("."):
+                continue
+            if line.endswith(":"):
+                self.labels[line[:-1]] = len(self.code)
+                continue
+            op, _, args = line.partition(" ")
+            self.code.append((op, [a.strip() for a in args.split(",") if a]))
+        self.reg = {}
+        self.c = 0
+        self.f0 = 0
+
+    def get(self, src):
+        if src.startswith("#"):
+            return int(src[1:]) & 0xFF
+        return self.reg[src]
+
+    def run(self, regs, cycle_count=False):
+        # returns dpl..a and the number of instructions, or of CH55x cycles
+        self.reg = dict(("r%d" % i, 0x5A) for i in range(8))
+        self.reg.update(a=0x5A, b=0x5A, dpl=0x5A, dph=0x5A)
+        self.reg.update(regs)
+        pc, steps = 0, 0
+        while pc < len(self.code):
+            op, args = self.code[pc]
+            pc += 1
+            last = pc
+            r = self.reg
+            if op == "ret":
+                pc = len(self.code)
+            elif op == "nop":
+                pass
+            elif op == "mov" and args[0] == "f0":
+                self.f0 = self.c
+            elif op == "mov":
+                r[args[0]] = self.get(args[1])
+            elif op == "clr" and args[0] == "c":
+                self.c = 0
+            elif op == "clr":
+                r["a"] = 0
+            elif op == "mul":
+                value = r["a"] * r["b"]
+                r["a"], r["b"] = value & 0xFF, value >> 8
+            elif op == "div":
+                r["a"], r["b"] = divmod(r["a"], r["b"])
+            elif op in ("add", "addc", "subb"):
+                value = self.get(args[1])
+                carry = self.c if op != "add" else 0
+                if op == "subb":
+                    result = r["a"] - value - carry
+                    self.c = int(result < 0)
+                else:
+                    result = r["a"] + value + carry
+                    self.c = int(result > 0xFF)
+                r["a"] = result & 0xFF
+            elif op == "rrc":
+                r["a"], self.c = (r["a"] >> 1) | (self.c << 7), r["a"] & 1
+            elif op == "rlc":
+                r["a"], self.c = ((r["a"] << 1) | self.c) & 0xFF, r["a"] >> 7
+            elif op == "inc":
+                r[args[0]] = (r[args[0]] + 1) & 0xFF
+            elif op == "jb":
+                if self.f0:
+                    pc = self.labels[args[1]]
+            elif op == "jc":
+                if self.c:
+                    pc = self.labels[args[0]]
+            elif op == "djnz":
+                r[args[0]] = (r[args[0]] - 1) & 0xFF
+                if r[args[0]]:
+                    pc = self.labels[args[1]]
+            elif op == "orl":
+                r["a"] |= self.get(args[1])
+            elif op == "jnc":
+                if not self.c:
+                    pc = self.labels[args[0]]
+            elif op == "jnz":
+                if r["a"]:
+                    pc = self.labels[args[0]]
+            elif op == "cjne":
+                if r[args[0]] != self.get(args[1]):
+                    pc = self.labels[args[2]]
+            else:
+                raise ValueError("unknown instruction " + op)
+            if cycle_count:
+                steps += op_cycles(op, args, pc != last)
+            else:
+                steps += 1
+        value = r["dpl"] | r["dph"] << 8 | r["b"] << 16 | r["a"] << 24
+        return value, steps
+
+
+def check():
+    random.seed(1)
+    for f_cpu, t0_cycle in CLOCKS:
+        tick = Fraction(12000000, f_cpu)
+        micros = Mcs51(micros_asm(f_cpu, t0_cycle).lines)
+        millis = Mcs51(millis_asm(f_cpu, t0_cycle).lines)
+        counts = [0, 1, 2 ** 32 - 1, 2 ** 32, 2 ** 40 - 1]
+        counts += [random.randrange(2 ** 40) for _ in range(3000)]
+        worst = [0, 0]
+        for m in counts:
+            regs = dict(("r%d" % i, (m >> (8 * i)) & 0xFF) for i in range(5))
+            for t in (0, 1, t0_cycle - 1, random.randrange(t0_cycle)):
+                regs["r5"] = t + 256 - t0_cycle
+                got, steps = micros.run(regs)
+                want = int((m * t0_cycle + t) * tick) % 2 ** 32
+                if got != want:
+                    sys.exit("micros at %d: m=%d t=%d got %d want %d" %
+                             (f_cpu, m, t, got, want))
+                worst[0] = max(worst[0], steps)
+            got, steps = millis.run(regs)
+            want = int(m * t0_cycle * tick / 1000) % 2 ** 32
+            if got != want:
+                sys.exit("millis at %d: m=%d got %d want %d" %
+                         (f_cpu, m, got, want))
+            worst[1] = max(worst[1], steps)
+        us_mul, us_div, ms_mul, ms_div = low_rate_ratios(f_cpu)
+        for ticks in [0, 2 ** 32 - 1] + [random.randrange(2 ** 44)
+                                         for _ in range(3000)]:
+            for mul, div, unit in ((us_mul, us_div, 1),
+                                   (ms_mul, ms_div, 1000)):
+                want = int(ticks * tick / unit) % 2 ** 32
+                if low_rate_scale(ticks, mul, div) != want:
+                    sys.exit("16 bit mode at %d: ticks=%d" % (f_cpu, ticks))
+        unit, pass_cycles = delay_unit(f_cpu)
+        delay = delay_asm(f_cpu)
+        shortest = delay_cycles(delay, 0)
+        for us in list(range(300)) + [255 * unit, 256 * unit, 257 * unit,
+                                      65535] + \
+                [random.randrange(65536) for _ in range(20)]:
+            cycles = delay_cycles(delay, us)
+            error = Fraction(cycles * 1000000, f_cpu) - us
+            if cycles > shortest + pass_cycles and abs(error) > unit / 2:
+                sys.exit("delayMicroseconds(%d) at %d: %s us off" %
+                         (us, f_cpu, error))
+        print("%9d Hz ok, micros %3d instructions, millis %3d instructions, "
+              "delay from %.2f us" % (f_cpu, worst[0], worst[1],
+                                      shortest * 1000000 / f_cpu))
+
+
+def low_rate_scale(ticks, mul, div):
+    # same steps as TIMER0_SCALE_TICKS in wiring.c
+    hi, lo = (ticks >> 16) % 2 ** 32, ticks & 0xFFFF
+    part = lo * mul
+    hi = (hi * mul + (part >> 16)) % 2 ** 32
+    lo = part & 0xFFFF
+    part = hi // div
+    lo = ((hi - part * div) << 16 | lo) // div
+    return ((part << 16) + lo) % 2 ** 32
+
+
+if __name__ == "__main__":
+    header = scriptPath + "/wiring_timing.h"
+    text = generate()
+    if "--check" in sys.argv:
+        with open(header) as fp:
+            if fp.read() != text:
+                sys.exit("wiring_timing.h is out of date, run generateTiming.py")
+        check()
+    else:
+        with open(header, "w") as fp:
+            fp.write(text)
@@ -0,0 +1,67 @@
+// Line buffer behind Print_printAll(). The values are formatted into
+// printLine and the output gets them as one string write (see
+// Print_setStringWrite), flushed early only if the buffer fills up. Not for
+// use from interrupts.
+
+#include "Arduino.h"
+
+#ifndef PRINT_LINE_SIZE
+#define PRINT_LINE_SIZE 32
+#endif
+
+__xdata char printLine[PRINT_LINE_SIZE + 1];
+__xdata uint8_t printLineLength;
+__xdata uint8_t printLineCount;
+__xdata writefunc_p printLineTarget;
+__bit printLineRegistered = 0;
+
+static void printLineFlush(void) {
+  if (printLineLength) {
+    printLine[printLineLength] = '\0';
+    printLineCount += Print_print_s(printLineTarget, printLine);
+    printLineLength = 0;
+  }
+}
+
+uint8_t Print_lineWrite(__data uint8_t c) {
+  if (printLineLength == PRINT_LINE_SIZE)
+    printLineFlush();
+  printLine[printLineLength++] = c;
+  return 1;
+}
+
+// numbers formatted by Print arrive here as one string
+uint8_t Print_lineWriteStr(char *str) {
+  __data uint8_t n = 0;
+  __data char c;
+
+  while (c = *str++) { // assignment intented
+    if (printLineLength == PRINT_LINE_SIZE)
+      printLineFlush();
+    printLine[printLineLength++] = c;
+    n++;
+  }
+  return n;
+}
+
+void Print_lineBegin(__data writefunc_p writefunc) {
+  if (!printLineRegistered) {
+    Print_setStringWrite(Print_lineWrite, Print_lineWriteStr);
+    printLineRegistered = 1;
+  }
+  printLineTarget = writefunc;
+  printLineLength = 0;
+  printLineCount = 0;
+}
+
+uint8_t Print_lineEnd(void) {
+  printLineFlush();
+  return printLineCount;
+}
+
+void Print_line_i(__data long i) { Print_print_i(Print_lineWrite, i); }
+void Print_line_u(__data unsigned long u) {
+  Print_print_u(Print_lineWrite, u);
+}
+void Print_line_s(char *__data s) { Print_lineWriteStr(s); }
+void Print_line_c(__data char c) { Print_lineWrite(c); }
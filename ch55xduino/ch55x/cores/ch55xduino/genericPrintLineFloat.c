@@ -0,0 +1,5 @@
+// Print_printAll() of a float, a separate file to avoid unnecessary linking
+
+#include "Arduino.h"
+
+void Print_line_f(__data float f) { Print_print_f(Print_lineWrite, f); }
@@ -31,6 +31,15 @@ void Serial1_print_sn_func(char *__data s, __xdata uint8_t size);
 void Serial1_print_f_func(__data float f);
 void Serial1_print_fd_func(__data float f, __xdata uint8_t digits);
 
+void Print_lineBegin(__data writefunc_p writefunc);
+uint8_t Print_lineWrite(__data uint8_t c);
+uint8_t Print_lineEnd(void);
+void Print_line_i(__data long i);
+void Print_line_u(__data unsigned long u);
+void Print_line_s(char *__data s);
+void Print_line_c(__data char c);
+void Print_line_f(__data float f);
+
 void printNothing();
 
 // https://stackoverflow.com/a/46222749/2561930
@@ -154,6 +163,44 @@ void printNothing();
     Print_println(Serial1_write);                                              \
   }
 
+// Print up to 8 values in one go, each chosen by its type at compile time like
+// the print() macros above, for example Serial0_printAll("T=", t, " H=", h).
+// They are formatted into a line buffer (PRINT_LINE_SIZE, default 32) and
+// sent as one string write. Returns the number of characters written.
+#define Print_printAll(W, ...)                                                 \
+  (Print_lineBegin(W),                                                         \
+   CONCAT(PRINT_ALL_, PRINT_ALL_NARG(__VA_ARGS__))(__VA_ARGS__),               \
+   Print_lineEnd())
+#define USBSerial_printAll(...) Print_printAll(USBSerial_write, __VA_ARGS__)
+#define Serial0_printAll(...) Print_printAll(Serial0_write, __VA_ARGS__)
+#define Serial1_printAll(...) Print_printAll(Serial1_write, __VA_ARGS__)
+
+#define PRINT_ALL_SELECT(_1)                                                   \
+  _Generic((_1),                                                               \
+      char: Print_line_c,                                                      \
+      signed char: Print_line_i,                                               \
+      int: Print_line_i,                                                       \
+      short: Print_line_i,                                                     \
+      long: Print_line_i,                                                      \
+      unsigned char: Print_line_u,                                             \
+      unsigned int: Print_line_u,                                              \
+      unsigned short: Print_line_u,                                            \
+      unsigned long: Print_line_u,                                             \
+      __code char *: Print_line_s,                                             \
+      __data char *: Print_line_s,                                             \
+      __xdata char *: Print_line_s,                                            \
+      float: Print_line_f)(_1)
+#define PRINT_ALL_1(_1) PRINT_ALL_SELECT(_1)
+#define PRINT_ALL_2(_1, ...) PRINT_ALL_SELECT(_1), PRINT_ALL_1(__VA_ARGS__)
+#define PRINT_ALL_3(_1, ...) PRINT_ALL_SELECT(_1), PRINT_ALL_2(__VA_ARGS__)
+#define PRINT_ALL_4(_1, ...) PRINT_ALL_SELECT(_1), PRINT_ALL_3(__VA_ARGS__)
+#define PRINT_ALL_5(_1, ...) PRINT_ALL_SELECT(_1), PRINT_ALL_4(__VA_ARGS__)
+#define PRINT_ALL_6(_1, ...) PRINT_ALL_SELECT(_1), PRINT_ALL_5(__VA_ARGS__)
+#define PRINT_ALL_7(_1, ...) PRINT_ALL_SELECT(_1), PRINT_ALL_6(__VA_ARGS__)
+#define PRINT_ALL_8(_1, ...) PRINT_ALL_SELECT(_1), PRINT_ALL_7(__VA_ARGS__)
+#define PRINT_ALL_NARG(...) PRINT_ALL_NARG_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1)
+#define PRINT_ALL_NARG_(_1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
 #define CONCAT(X, Y) CONCAT_(X, Y)
 #define CONCAT_(X, Y) X##Y
 
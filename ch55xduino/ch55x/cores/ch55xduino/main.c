@@ -43,6 +43,16 @@ __idata __at (0x0C) volatile uint8_t timer0_overflow_count_5th_byte = 0;
 void Timer0Interrupt(void) __interrupt(INT_NO_TMR0) __using(1);
 
 void Uart0_ISR(void) __interrupt(INT_NO_UART0) {
+#ifdef USB_CDC_UART_BRIDGE
+  if (RI) {
+    uart0BridgeRxHandler();
+    RI = 0;
+  }
+  if (TI) {
+    TI = 0;
+    uart0BridgeTxHandler();
+  }
+#else
   if (RI) {
     uart0IntRxHandler();
     RI = 0;
@@ -51,6 +61,7 @@ void Uart0_ISR(void) __interrupt(INT_NO_UART0) {
     uart0IntTxHandler();
     TI = 0;
   }
+#endif
 }
 
 void Uart1_ISR(void) __interrupt(INT_NO_UART1) {
@@ -67,6 +78,9 @@ void Uart1_ISR(void) __interrupt(INT_NO_UART1) {
   uint8_t interruptStatus = SER1_IIR & 0x0f;
   switch (interruptStatus) {
   case U1_INT_RECV_RDY:
+#ifdef SERIAL1_FIFO_TRIG
+  case U1_INT_RECV_TOUT: // fewer bytes than the trigger level are waiting
+#endif
     uart1IntRxHandler();
     break;
   case U1_INT_THR_EMPTY:
@@ -87,6 +101,11 @@ void Uart1_ISR(void) __interrupt(INT_NO_UART1) {
 
 typedef void (*voidFuncPtr)(void);
 extern __xdata voidFuncPtr intFunc[];
+
+// set to softTimer_poll by the first software timer, see wiring_timer.c
+__data voidFuncPtr softTimerPollHook = NULL;
+// set to task_run by the first task_start(), see wiring_task.c
+__data voidFuncPtr taskRunHook = NULL;
 void INT0_ISR(void) __interrupt(INT_NO_INT0) { intFunc[0](); }
 void INT1_ISR(void) __interrupt(INT_NO_INT1) { intFunc[1](); }
 
@@ -102,14 +121,21 @@ void TOUCHKEY_ISR(void) __interrupt(INT_NO_TKEY) {
 void main(void) {
   init();
 
+#ifdef USB_CDC_UART_BRIDGE
+  USBSerial_bridgePoll(); // start Serial0 with the default line coding
+#endif
+
   //!!!initVariant();
 
   setup();
 
   for (;;) {
     loop();
+    yield();
     if (1) {
-#ifndef USER_USB_RAM
+#if defined(USB_CDC_UART_BRIDGE)
+      USBSerial_bridgePoll(); // apply line coding sent by the host
+#elif !defined(USER_USB_RAM)
       USBSerial_flush();
 #endif
       // serialEvent();
@@ -0,0 +1,25 @@
+// SDCC doesn't support weak attribute. But function in sketch can override
+// function in library. Arduino compiles core as an archive and linked with the
+// sketch
+#include "wiring_private.h"
+
+extern __data voidFuncPtr softTimerPollHook;
+extern __data voidFuncPtr taskRunHook;
+
+__bit yieldBusy = 0;
+
+// Called after every loop() and while delay() waits. Does not nest, so a timer
+// callback or task that calls delay() just waits.
+void yield(void) {
+  if (yieldBusy) {
+    return;
+  }
+  yieldBusy = 1;
+  if (softTimerPollHook != NULL) {
+    softTimerPollHook();
+  }
+  if (taskRunHook != NULL) {
+    taskRunHook();
+  }
+  yieldBusy = 0;
+}
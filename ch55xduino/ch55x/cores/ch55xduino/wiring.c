@@ -3,6 +3,7 @@
  */
 
 #include "wiring_private.h"
+#include "wiring_timing.h"
 
 #ifndef USER_USB_RAM
 void USBDeviceCfg();
@@ -10,14 +11,22 @@ void USBDeviceIntCfg();
 void USBDeviceEndPointCfg();
 #endif
 
-extern __idata volatile uint32_t timer0_overflow_count;
-extern __idata volatile uint8_t timer0_overflow_count_5th_byte;
+// Set by setClock() once the clock differs from F_CPU, see wiring_clock.c
+__data timer0TimeFuncPtr timer0TimeHook = NULL;
+__xdata timer0Time64FuncPtr timer0Time64Hook = NULL;
+// Set by the first software timer and task_start(), see wiring_clock.c
+__xdata clockChangeFuncPtr softTimerClockHook = NULL;
+__xdata clockChangeFuncPtr taskClockHook = NULL;
 
-#if F_CPU == 56000000
-#define T0_CYCLE 224
-#else
-#define T0_CYCLE 250
-#endif
+// 1 tick = (timer0UsMul / timer0UsDiv) us, setClock() changes them
+__xdata uint16_t timer0UsMul = T0_US_MUL;
+__xdata uint16_t timer0UsDiv = T0_US_DIV;
+
+// Timer0 reloads every T0_CYCLE ticks of F_CPU/12, so Timer0Interrupt runs
+// 8000 times a second at 24 MHz (about 20 cycles each, under 1% of the CPU).
+// TIMER0_LOW_TICK_RATE trades that for a slower millis(), see below.
+// T0_CYCLE, the scaling code and the delayMicroseconds() loop for each F_CPU
+// are in wiring_timing.h, generated by generateTiming.py.
 
 // using register bank 1
 void Timer0Interrupt(void) __interrupt(INT_NO_TMR0) __using(1) {
@@ -36,7 +45,45 @@ void Timer0Interrupt(void) __interrupt(INT_NO_TMR0) __using(1) {
           "incTimer0_overflow_countOver$:                  \n");
 }
 
+#ifdef TIMER0_LOW_TICK_RATE
+// Timer0 counts F_CPU/12 in 16 bit mode 1 and only interrupts when the 16 bit
+// counter overflows, every 65536 ticks: about 30 times a second at 24 MHz
+// instead of 8000 with the 8 bit auto reload. micros() and millis() scale the
+// 48 bit tick count made of timer0_overflow_count on top of TH0:TL0.
+
+// 1 tick = (T0_US_MUL / T0_US_DIV) us = (T0_MS_MUL / T0_MS_DIV) ms, from
+// wiring_timing.h
+
 uint32_t micros() {
+  __data uint32_t hi;
+  __data uint16_t lo;
+
+  if (timer0TimeHook != NULL) {
+    return timer0TimeHook(0);
+  }
+  TIMER0_READ_TICKS(hi, lo);
+  TIMER0_SCALE_TICKS(hi, lo, T0_US_MUL, T0_US_DIV);
+  return hi;
+}
+
+uint32_t millis() {
+  __data uint32_t hi;
+  __data uint16_t lo;
+
+  if (timer0TimeHook != NULL) {
+    return timer0TimeHook(1);
+  }
+  TIMER0_READ_TICKS(hi, lo);
+  TIMER0_SCALE_TICKS(hi, lo, T0_MS_MUL, T0_MS_DIV);
+  return hi;
+}
+
+#else
+
+uint32_t micros() {
+  if (timer0TimeHook != NULL) {
+    return timer0TimeHook(0);
+  }
   /*uint32_t m;
    uint8_t t;
    uint8_t interruptOn = EA;
@@ -56,22 +103,23 @@ uint32_t micros() {
           "    mov c,_EA                                \n"
           ";EA = 0;                                     \n"
           "    clr _EA                                  \n"
-          ";Copy _timer0_overflow_count to local R0~R3,m\n"
+          ";Copy _timer0_overflow_count to local R0~R4,m\n"
           "    mov r0, (_timer0_overflow_count)         \n"
           "    mov r1, (_timer0_overflow_count)+1       \n"
           "    mov r2, (_timer0_overflow_count)+2       \n"
           "    mov r3, (_timer0_overflow_count)+3       \n"
-          ";Copy TL0 to local R4, t                     \n"
-          "    mov r4, _TL0                             \n"
-          ";Copy TCON (TF0) to local R5                 \n"
+          "    mov r4, (_timer0_overflow_count)+4       \n"
+          ";Copy TL0 to local R5, t                     \n"
+          "    mov r5, _TL0                             \n"
+          ";Copy TCON (TF0) to b                        \n"
           "    mov b, _TCON                             \n"
           ";if (interruptOn) EA = 1;                    \n"
           "    mov _EA,c                                \n"
 
-          ";if ((TF0 in b) && (R4 != 255)){             \n"
+          ";if ((TF0 in b) && (R5 != 255)){             \n"
           "    jnb b.5,incTimer0_overf_cntCopyOver$     \n"
           "    mov a,#1     \n"
-          "    add a,r4     \n"
+          "    add a,r5     \n"
           "    jz incTimer0_overf_cntCopyOver$\n"
 
           ";m++                                         \n"
@@ -82,507 +130,18 @@ uint32_t micros() {
           "    inc r2                                   \n"
           "    cjne r2,#0,incTimer0_overf_cntCopyOver$  \n"
           "    inc r3                                   \n"
+          "    cjne r3,#0,incTimer0_overf_cntCopyOver$  \n"
+          "    inc r4                                   \n"
           "incTimer0_overf_cntCopyOver$:                \n");
 
-  // since TL0 (R4) always ranging from (256-T0_CYCLE) to 255, we can reduce R4
-  // by (256-T0_CYCLE)
-
-#if T0_CYCLE == 250
-  __asm__("    clr c                                    \n"
-          "    mov a, r4                                \n"
-          "    subb a,#6                                \n"
-          "    mov r4, a                                \n");
-#elif T0_CYCLE == 224
-  __asm__("    clr c                                    \n"
-          "    mov a, r4                                \n"
-          "    subb a,#32                               \n"
-          "    mov r4, a                                \n");
-#endif
-
-#if F_CPU == 16000000
-  // 1m = 250t 1t=0.75us (m*250+t)*3/2/2
-  // m in r0~r3
-  // t in r4
-  // t=((3*t)>>1);
-  // m=(m*375)=m<<8+m*119;
-  // return (m+t)>>1
-
-  __asm__(";1m = 250t 1t=0.5us (m*250+t)*3/2/2  t is 0~249\n"
-          ";we need to return (m<<8+m*119+((3*t)>>1)))>>1 \n"
-
-          ";m=m*119;                                    \n"
-          "    mov a, r0                                \n"
-          "    mov r6, a                                \n"
-          "    mov a, r1                                \n"
-          "    mov r7, a                                \n"
-          "    push ar3                                 \n"
-          "    push ar2                                 \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, a                                \n"
-          "    mov r5, b                                \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r1, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r2, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r3, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          ";m=m+m<<8;                                   \n"
-
-          "    mov a, r6                                \n"
-          "    add a, r1                                \n"
-          "    mov r1, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r2                               \n"
-          "    mov r2, a                                \n"
-          "    pop a                                    \n"
-          "    addc a, r3                               \n"
-          "    mov r3, a                                \n"
-          "    pop a                                    \n"
-          "    addc a, r5                               \n"
-          "    mov r5, a                                \n"
-
-          ";t=((3*t)>>1));                              \n"
-
-          "    mov b, #3                                \n"
-          "    mov a, r4                                \n"
-          "    mul ab                                   \n"
-          "    mov r4, a                                \n"
-          "    mov a, b                                 \n"
-          "    clr c                                    \n"
-          "    rrc a                                    \n"
-          "    mov r6, a                                \n"
-          "    mov a, r4                                \n"
-          "    rrc a                                    \n"
-          "    mov r4, a                                \n"
-
-          ";get m+t                                     \n"
-          "    mov r7, #0                               \n"
-          "    mov a, r4                                \n"
-          "    add a, r0                                \n"
-          "    mov r0, a                                \n"
-          "    mov a, r6                                \n"
-          "    addc a, r1                               \n"
-          "    mov r1, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r2                               \n"
-          "    mov r2, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r3                               \n"
-          "    mov r3, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r5                               \n"
-          "    mov r5, a                                \n"
-
-          ";return m+t/2                                \n"
-          "    clr c                                    \n"
-          "    mov a, r5                                \n"
-          "    rrc a                                    \n"
-          "    mov r5, a                                \n"
-          "    mov a, r3                                \n"
-          "    rrc a                                    \n"
-          "    mov r3, a                                \n"
-          "    mov a, r2                                \n"
-          "    rrc a                                    \n"
-          "    mov b, a                                 \n"
-          "    mov a, r1                                \n"
-          "    rrc a                                    \n"
-          "    mov dph, a                               \n"
-          "    mov a, r0                                \n"
-          "    rrc a                                    \n"
-          "    mov dpl, a                               \n"
-          "    mov a, r3                                \n"
-
-  );
-  // ’dpl’ (LSB),’dph’,’b’ & ’acc’
-#elif F_CPU == 24000000
-  // 24M CLK
-
-  /*1m = 250t 1t=0.5us (m*250+t)/2
-
-  t=(t>>1);
-  m=m*125;
-
-  return ( m+t );*/
-
-  // assembly has better support for multiplication
-
-  __asm__(";1m = 250t 1t=0.5us (m*250+t)/2  t is 0~249  \n"
-          ";we need to return m*125+t/2                 \n"
-          ";t=(t>>1);                                   \n"
-          "    mov a,r4                                 \n"
-          "    clr c                                    \n"
-          "    rrc a                                    \n"
-          "    mov r4,a                                 \n"
-
-          ";m=m*125;                                    \n"
-          "    mov b, #125                              \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, a                                \n"
-          "    mov r5, b                                \n"
-
-          "    mov b, #125                              \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r1, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #125                              \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r2, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #125                              \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r3, a                                \n"
-
-          ";return m+t                                  \n"
-          "    mov r5, #0                               \n"
-          "    mov a, r4                                \n"
-          "    add a, r0                                \n"
-          "    mov dpl, a                               \n"
-          "    mov a, r1                                \n"
-          "    addc a, r5                               \n"
-          "    mov dph, a                               \n"
-          "    mov a, r2                                \n"
-          "    addc a, r5                               \n"
-          "    mov b, a                                 \n"
-          "    mov a, r3                                \n"
-          "    addc a, r5                               \n"
-
-  );
-#elif F_CPU == 32000000
-  // 1m = 250t 1t=0.375us (m*250+t)*3/2/2/2
-  // m in r0~r3
-  // t in r4
-  // t=((3*t)>>1);
-  // m=(m*375)=m<<8+m*119;
-  // return (m+t)>>2
-
-  __asm__(";1m = 250t 1t=0.5us (m*250+t)*3/2/2  t is 0~249\n"
-          ";we need to return (m<<8+m*119+((3*t)>>1)))>>1 \n"
-
-          ";m=m*119;                                    \n"
-          "    mov a, r0                                \n"
-          "    mov r6, a                                \n"
-          "    mov a, r1                                \n"
-          "    mov r7, a                                \n"
-          "    push ar3                                 \n"
-          "    push ar2                                 \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, a                                \n"
-          "    mov r5, b                                \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r1, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r2, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #119                              \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r3, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          ";m=m+m<<8;                                   \n"
-
-          "    mov a, r6                                \n"
-          "    add a, r1                                \n"
-          "    mov r1, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r2                               \n"
-          "    mov r2, a                                \n"
-          "    pop a                                    \n"
-          "    addc a, r3                               \n"
-          "    mov r3, a                                \n"
-          "    pop a                                    \n"
-          "    addc a, r5                               \n"
-          "    mov r5, a                                \n"
-
-          ";t=((3*t)>>1));                              \n"
-
-          "    mov b, #3                                \n"
-          "    mov a, r4                                \n"
-          "    mul ab                                   \n"
-          "    mov r4, a                                \n"
-          "    mov a, b                                 \n"
-          "    clr c                                    \n"
-          "    rrc a                                    \n"
-          "    mov r6, a                                \n"
-          "    mov a, r4                                \n"
-          "    rrc a                                    \n"
-          "    mov r4, a                                \n"
-
-          ";get m+t                                     \n"
-          "    mov r7, #0                               \n"
-          "    mov a, r4                                \n"
-          "    add a, r0                                \n"
-          "    mov r0, a                                \n"
-          "    mov a, r6                                \n"
-          "    addc a, r1                               \n"
-          "    mov r1, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r2                               \n"
-          "    mov r2, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r3                               \n"
-          "    mov r3, a                                \n"
-          "    mov a, r7                                \n"
-          "    addc a, r5                               \n"
-          "    mov r5, a                                \n"
-
-          ";return m+t/2                                \n"
-          "    clr c                                    \n"
-          "    mov a, r5                                \n"
-          "    rrc a                                    \n"
-          "    mov r5, a                                \n"
-          "    mov a, r3                                \n"
-          "    rrc a                                    \n"
-          "    mov r3, a                                \n"
-          "    mov a, r2                                \n"
-          "    rrc a                                    \n"
-          "    mov r2, a                                \n"
-          "    mov a, r1                                \n"
-          "    rrc a                                    \n"
-          "    mov r1, a                                \n"
-          "    mov a, r0                                \n"
-          "    rrc a                                    \n"
-          "    mov r0, a                                \n"
-
-          ";return m+t/2/2                              \n"
-          "    clr c                                    \n"
-          "    mov a, r5                                \n"
-          "    rrc a                                    \n"
-          "    mov r5, a                                \n"
-          "    mov a, r3                                \n"
-          "    rrc a                                    \n"
-          "    mov r3, a                                \n"
-          "    mov a, r2                                \n"
-          "    rrc a                                    \n"
-          "    mov b, a                                 \n"
-          "    mov a, r1                                \n"
-          "    rrc a                                    \n"
-          "    mov dph, a                               \n"
-          "    mov a, r0                                \n"
-          "    rrc a                                    \n"
-          "    mov dpl, a                               \n"
-          "    mov a, r3                                \n"
-
-  );
-  // ’dpl’ (LSB),’dph’,’b’ & ’acc’
-#elif F_CPU == 56000000
-  // 56M CLK
-
-  /*1m = 224t 1t=0.21412us=3/14us (m*224+t)*3/14
-   m*48+t*3/14
-   //m in r0~r3
-   //t in r4*/
-
-  // assembly has better support for multiplication
-
-  __asm__(";t=t*3/14; t ranging 0~223                   \n"
-          "    mov a,r4                                 \n"
-          "    mov b,#14                                \n"
-          "    div ab                                   \n"
-          "    mov r5,b                                 \n"
-          "    mov b,#3                                 \n"
-          "    mul ab                                   \n"
-          "    mov r4,a                                 \n"
-          ";now r4=int(r4/14)*3                         \n"
-          ";r4=r4+reminder*3/14                         \n"
-          "    mov a,r5                                 \n"
-          "    mov b,#3                                 \n"
-          "    mul ab                                   \n"
-          "    mov b,#14                                \n"
-          "    div ab                                   \n"
-          "    add a,r4                                 \n"
-          "    mov r4,a                                 \n"
-
-          ";m=m*48;                                     \n"
-          "    mov b, #48                               \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, a                                \n"
-          "    mov r5, b                                \n"
-
-          "    mov b, #48                               \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r1, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #48                               \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r2, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #48                               \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r3, a                                \n"
-          // 5th byte not needed
-          //"    clr a                                    \n"
-          //"    addc a, b                                \n"
-          //"    mov r5, a                                \n"
-
-          ";m=m+t                                       \n"
-          "    mov r6, #0                               \n"
-          "    mov a, r4                                \n"
-          "    add a, r0                                \n"
-          "    mov r0, a                                \n"
-          "    mov a, r1                                \n"
-          "    addc a, r6                               \n"
-          "    mov r1, a                                \n"
-          "    mov a, r2                                \n"
-          "    addc a, r6                               \n"
-          "    mov r2, a                                \n"
-          "    mov a, r3                                \n"
-          "    addc a, r6                               \n"
-          "    mov r3, a                                \n"
-          // 5th byte not needed
-          //"    mov a, r5                                \n"
-          //"    addc a, r6                               \n"
-          //"    mov r5, a                                \n"
-
-          ";return                                      \n"
-
-          "    mov dpl, r0                              \n"
-          "    mov dph, r1                              \n"
-          "    mov b, r2                                \n"
-          "    mov a, r3                                \n"
-
-  );
-#elif F_CPU == 12000000
-  // 12M CLK
-
-  /*1m = 250t 1t=1us (m*250+t)
-
-   t=(t);
-   m=m*250;
-
-   return ( m+t );*/
-
-  // assembly has better support for multiplication
-
-  __asm__(";1m = 250t 1t=1us (m*250+t)    t is 0~249    \n"
-          ";we need to return m*250+t                   \n"
-
-          ";m=m*250;                                    \n"
-          "    mov b, #250                              \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, a                                \n"
-          "    mov r5, b                                \n"
-
-          "    mov b, #250                              \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r1, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #250                              \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r2, a                                \n"
-          "    clr a                                    \n"
-          "    addc a, b                                \n"
-          "    mov r5, a                                \n"
-
-          "    mov b, #250                              \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    add a, r5                                \n"
-          "    mov r3, a                                \n"
-
-          ";return m+t                                  \n"
-          "    mov r5, #0                               \n"
-          "    mov a, r4                                \n"
-          "    add a, r0                                \n"
-          "    mov dpl, a                               \n"
-          "    mov a, r1                                \n"
-          "    addc a, r5                               \n"
-          "    mov dph, a                               \n"
-          "    mov a, r2                                \n"
-          "    addc a, r5                               \n"
-          "    mov b, a                                 \n"
-          "    mov a, r3                                \n"
-          "    addc a, r5                               \n"
-
-  );
-#else
-#error "clock not supported yet"
-
-#endif
-  // return values: ’dpl’ 1B, ’dpl’ LSB & ’dph’ 2B,
-  // ’dpl’, ’dph’ and ’b’ 3B, ’dpl’,’dph’,’b’ & ’acc’ 4B
+  // m in r0~r4, TL0 in r5, return in 'dpl' (LSB),'dph','b' & 'acc'
+  __asm__(MICROS_SCALE_ASM);
 }
 
 uint32_t millis() {
+  if (timer0TimeHook != NULL) {
+    return timer0TimeHook(1);
+  }
 
   // disable interrupts while we read timer0_millis or we might get an
   // inconsistent value (e.g. in the middle of a write to timer0_millis)
@@ -604,287 +163,96 @@ uint32_t millis() {
           ";if (interruptOn) EA = 1;                    \n"
           "    mov _EA,c                                \n");
 
-#if F_CPU == 16000000
-  __asm__(";return (timer0_overflow_count*48)>>8        \n"
-
-          "    mov b, #48                               \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, b                                \n"
-          ";lowest 8 bit not used (a), r0 free to use   \n"
-          "    mov b, #48                               \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          "    mov r5, psw   ;keep c                    \n"
-          "    mov dpl, a                               \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #48                               \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    mov psw, r5   ;restore c                 \n"
-          "    addc a, r0                               \n"
-          "    mov r5, psw   ;keep c                    \n"
-          "    mov dph, a                               \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #48                               \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    mov psw, r5   ;restore c                 \n"
-          "    addc a, r0                               \n"
-          "    mov r5, psw   ;keep c                    \n"
-          "    mov r1, a                                \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #48                               \n"
-          "    mov a, r4                                \n"
-          "    mul ab                                   \n"
-          "    mov psw, r5   ;restore c                 \n"
-          "    addc a, r0                               \n"
-
-          ";calculation finished, a already in place    \n"
-          "    mov b, r1                                \n");
-
-#elif F_CPU == 24000000
-  __asm__(";return timer0_overflow_count>>3             \n"
-          ";Or: return (timer0_overflow_count<<5)>>8    \n"
-          ";Or: return (timer0_overflow_count*32)>>8    \n"
-          "    mov b, #32                               \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, b                                \n"
-          ";lowest 8 bit not used (a), r0 free to use   \n"
-          "    mov b, #32                               \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
-          "    mov dpl, a                               \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #32                               \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
-          "    mov dph, a                               \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #32                               \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
-          "    mov r1, a                                \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #32                               \n"
-          "    mov a, r4                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
-
-          ";calculation finished, a already in place    \n"
-          "    mov b, r1                                \n");
-
-#elif F_CPU == 32000000
-  __asm__(";return (timer0_overflow_count*24)>>8        \n"
-
-          "    mov b, #24                               \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, b                                \n"
-          ";lowest 8 bit not used (a), r0 free to use   \n"
-          "    mov b, #24                               \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          "    mov r5, psw   ;keep c                    \n"
-          "    mov dpl, a                               \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #24                               \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    mov psw, r5   ;restore c                 \n"
-          "    addc a, r0                               \n"
-          "    mov r5, psw   ;keep c                    \n"
-          "    mov dph, a                               \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #24                               \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    mov psw, r5   ;restore c                 \n"
-          "    addc a, r0                               \n"
-          "    mov r5, psw   ;keep c                    \n"
-          "    mov r1, a                                \n"
-          "    mov r0, b                                \n"
-
-          "    mov b, #24                               \n"
-          "    mov a, r4                                \n"
-          "    mul ab                                   \n"
-          "    mov psw, r5   ;restore c                 \n"
-          "    addc a, r0                               \n"
-
-          ";calculation finished, a already in place    \n"
-          "    mov b, r1                                \n");
-
-#elif F_CPU == 56000000
-  __asm__(
-      ";return timer0_overflow_count*6/125          \n"
-      // mutiply by 6
-      "    mov b, #6                                \n"
-      "    mov a, r0                                \n"
-      "    mul ab                                   \n"
-      "    mov r0, a                                \n"
-      "    mov r5, b                                \n"
-
-      "    mov b, #6                                \n"
-      "    mov a, r1                                \n"
-      "    mul ab                                   \n"
-      "    add a, r5                                \n"
-      "    mov r1, a                                \n"
-      "    clr a                                    \n"
-      "    addc a, b                                \n"
-      "    mov r5, a                                \n"
-
-      "    mov b, #6                                \n"
-      "    mov a, r2                                \n"
-      "    mul ab                                   \n"
-      "    add a, r5                                \n"
-      "    mov r2, a                                \n"
-      "    clr a                                    \n"
-      "    addc a, b                                \n"
-      "    mov r5, a                                \n"
-
-      "    mov b, #6                                \n"
-      "    mov a, r3                                \n"
-      "    mul ab                                   \n"
-      "    add a, r5                                \n"
-      "    mov r3, a                                \n"
-      "    clr a                                    \n"
-      "    addc a, b                                \n"
-      "    mov r5, a                                \n"
-
-      "    mov b, #6                                \n"
-      "    mov a, r4                                \n"
-      "    mul ab                                   \n"
-      "    add a, r5                                \n"
-      "    mov r4, a                                \n"
-      "    clr a                                    \n"
-      "    addc a, b                                \n"
-      "    mov r5, a                                \n"
+  // m in r0~r4, return in 'dpl' (LSB),'dph','b' & 'acc'
+  __asm__(MILLIS_SCALE_ASM);
+  // return values: ’dpl’ 1B, ’dpl’ LSB & ’dph’ 2B,
+  // ’dpl’, ’dph’ and ’b’ 3B, ’dpl’,’dph’,’b’ & ’acc’ 4B
+}
 
-      // ref:MCS51 三字节无符号除法程序（ASM）modify for 6 bytes
-      "    mov r7,#125                              \n"
-      "    mov a,r5                                 \n"
-      "    mov b,r7                                 \n"
-      "    div ab                                   \n"
-      "    mov r5,b                                 \n"
-      "    mov r6,a                                 \n"
-      "    mov b,#40                                \n"
-      ";after keeping high result, iterate all B bit with left shift \n"
-      "1$: ;div125_iter_bits                        \n"
-      "    clr c                                    \n"
-      "    mov a,r0                                 \n"
-      "    rlc a                                    \n"
-      "    mov r0,a                                 \n"
-      "    mov a,r1                                 \n"
-      "    rlc a                                    \n"
-      "    mov r1,a                                 \n"
-      "    mov a,r2                                 \n"
-      "    rlc a                                    \n"
-      "    mov r2,a                                 \n"
-      "    mov a,r3                                 \n"
-      "    rlc a                                    \n"
-      "    mov r3,a                                 \n"
-      "    mov a,r4                                 \n"
-      "    rlc a                                    \n"
-      "    mov r4,a                                 \n"
-      "    mov a,r5                                 \n"
-      "    rlc a                                    \n"
-      "    mov r5,a                                 \n"
-      "    mov f0,c                                 \n"
-      "    clr c                                    \n"
-      "    subb a,r7                                \n"
-      ";get 1 for result with overflow on shift or non-negitive subb result \n"
-      "    jb f0,2$                                 \n"
-      "    jc 3$    ;get 0 for this bit             \n"
-      "2$: ;shift overflow                          \n"
-      "    mov r5,a                                 \n"
-      "    inc r0                                   \n"
-      "3$: ;iternate next bit                       \n"
-      "    djnz b,1$                                \n"
-      "    mov a,r6                                 \n"
-      "    clr ov                                   \n"
-      "    jz 4$                                    \n"
-      "    setb ov                                  \n"
-      "4$: ;finish calculation, set high byte and reminder \n"
-      "    xch a,r5                                 \n"
-      "    mov r7,a                                 \n"
+#endif
 
-      ";return                                      \n"
-      "    mov dpl, r0                              \n"
-      "    mov dph, r1                              \n"
-      "    mov b, r2                                \n"
-      "    mov a, r3                                \n"
+// Ticks of F_CPU/12 since start, with all five overflow count bytes. The
+// default mode wraps after 2^40 overflows, about 4 years at 24 MHz.
+static uint64_t timer0Ticks64(void) {
+  __data uint64_t m;
+#ifdef TIMER0_LOW_TICK_RATE
+  __data uint8_t th;
+  __data uint16_t t;
+#else
+  __data uint8_t t;
+#endif
+  __bit interruptOn = EA;
+
+  EA = 0;
+  m = timer0_overflow_count |
+      ((uint64_t)timer0_overflow_count_5th_byte << 32);
+#ifdef TIMER0_LOW_TICK_RATE
+  do {
+    th = TH0;
+    t = TL0;
+  } while (th != TH0);
+  if (TF0 && !(th & 0x80)) {
+    m++;
+  }
+  EA = interruptOn;
+  return (m << 16) | t | ((uint16_t)th << 8);
+#else
+  t = TL0;
+  if (TF0 && (t < 255)) {
+    m++;
+  }
+  EA = interruptOn;
+  return m * T0_CYCLE + (uint8_t)(t - (256 - T0_CYCLE));
+#endif
+}
 
-  );
-#elif F_CPU == 12000000
-  __asm__(";return timer0_overflow_count>>2             \n"
-          ";Or: return (timer0_overflow_count<<6)>>8    \n"
-          ";Or: return (timer0_overflow_count*64)>>8    \n"
-          "    mov b, #64                               \n"
-          "    mov a, r0                                \n"
-          "    mul ab                                   \n"
-          "    mov r0, b                                \n"
-          ";lowest 8 bit not used (a), r0 free to use   \n"
-          "    mov b, #64                               \n"
-          "    mov a, r1                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
-          "    mov dpl, a                               \n"
-          "    mov r0, b                                \n"
+uint64_t micros64() {
+  if (timer0Time64Hook != NULL) {
+    return timer0Time64Hook(0);
+  }
+  return timer0Ticks64() * T0_US_MUL / T0_US_DIV;
+}
 
-          "    mov b, #64                               \n"
-          "    mov a, r2                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
-          "    mov dph, a                               \n"
-          "    mov r0, b                                \n"
+uint64_t millis64() {
+  if (timer0Time64Hook != NULL) {
+    return timer0Time64Hook(1);
+  }
+  return timer0Ticks64() * T0_MS_MUL / T0_MS_DIV;
+}
 
-          "    mov b, #64                               \n"
-          "    mov a, r3                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
-          "    mov r1, a                                \n"
-          "    mov r0, b                                \n"
+#ifdef TIMER0_LOW_TICK_RATE
+#define T0_PERIOD 65536UL
+#else
+#define T0_PERIOD T0_CYCLE
+#endif
 
-          "    mov b, #64                               \n"
-          "    mov a, r4                                \n"
-          "    mul ab                                   \n"
-          "    add a, r0                                \n"
-          ";carry won't be set, if I calculated right   \n"
+// Low 4 bytes of the overflow count, the clock of software timers and tasks
+uint32_t timer0_overflows(void) {
+  __data uint32_t count;
+  __bit interruptOn = EA;
+  EA = 0;
+  count = timer0_overflow_count;
+  EA = interruptOn;
+  return count;
+}
 
-          ";calculation finished, a already in place    \n"
-          "    mov b, r1                                \n");
-#else
-#error "clock not supported yet"
+// us rounded up to whole Timer0 overflows at the current clock, at least one
+uint32_t timer0_usToOverflows(__data uint32_t us) {
+  __data uint32_t period = (uint32_t)T0_PERIOD * timer0UsMul;
+  __data uint32_t count = ((uint64_t)us * timer0UsDiv + period - 1) / period;
+  return count ? count : 1;
+}
 
-#endif
+// the other way, rounded down
+uint32_t timer0_overflowsToUs(__data uint32_t count) {
+  return (uint64_t)count * T0_PERIOD * timer0UsMul / timer0UsDiv;
 }
 
 void delay(__data uint32_t ms) {
   __data uint32_t start = micros();
 
   while (ms > 0) {
-    // yield();
+    yield();
     while (ms > 0 && (micros() - start) >= 1000) {
       ms--;
       start += 1000;
@@ -892,250 +260,13 @@ void delay(__data uint32_t ms) {
   }
 }
 
+// A counted loop from wiring_timing.h, so it works with interrupts off and
+// from interrupts. The time of the call ("mov dptr, #n" and lcall) and the
+// return is taken off. Interrupts that run meanwhile make it longer. Below
+// 12 MHz one loop pass is several us and us is rounded to whole passes.
 void delayMicroseconds(__data uint16_t us) {
-  // call with const, "mov dptr, #CONST" and "lcall", 3 + (6 or 7) cycles,
-  // depending on even or odd address call with var, "mov dpl, r", "mov dph, r",
-  // and "lcall", 2 + 2 + (6 or 7) cycles, depending on odd or even address The
-  // compiler by default uses a caller saves convention for register saving
-  // across function calls
   us; // avoid unreferenced function argument warning
-#if F_CPU >= 56000000UL
-  __asm__(
-      ".even                                    \n"
-      "    mov  r6, dpl                         \n" // low 8-bit
-      "    mov  r7, dph                         \n" // high 8-bit
-      "    clr  c                               \n"
-      "    mov  a,#0x00                         \n"
-      "    subb a, r6                           \n"
-      "    clr  a                               \n"
-      "    subb a, r7                           \n"
-      "    jc skip_0us$                         \n"
-      "    ret                                  \n" // return if 0 us  about
-                                                    // 0.48us total
-      "    nop                                  \n"
-      "skip_0us$:                               \n"
-      "    clr  c                               \n" // do some loop init, not
-                                                    // useful for 1us but better
-                                                    // here
-      "    mov  a, #0x01                        \n"
-      "    subb a, r6                           \n"
-      "    mov  r6, a                           \n"
-      "    mov  a, #0x00                        \n"
-      "    subb a, r7                           \n"
-      "    mov  r7, a                           \n"
-
-      "    nop                                  \n" // keep even
-      "    nop \n nop \n nop \n nop \n nop \n     "
-      "    nop \n nop \n nop \n nop \n nop \n     "
-      "    cjne r6,#0x00,loop56m_us$            \n"
-      "    cjne r7,#0x00,loop56m_us$            \n"
-      "    nop \n                                 "
-      "    ret                                  \n" // return if 1us  about 1 us
-                                                    // total
-
-      "loop56m_us$:                             \n" // about nus
-      "    nop                                  \n" // 6 cycle
-      "    nop \n nop \n nop \n nop \n nop \n     "
-      "loop56m_us_2$:                           \n"
-
-      "    mov r5, #7                           \n" // 2 cycle
-      "loop_rep_nop$:                           \n"
-      "    djnz r5, loop_rep_nop$               \n" // 6*6+2 = 38 cycle
-      "    nop \n nop \n nop \n                   " // 3 cycle
-      "    inc  r6                              \n" // 1 cycle
-      "    cjne r6, #0,loop56m_us$              \n" // 6 cycle
-      "    inc  r7                              \n" // there will be extra 1
-                                                    // cycles for every 256us
-      "    cjne r7, #0,loop56m_us_2$            \n");
-#elif F_CPU >= 32000000UL
-  __asm__(
-      ".even                                    \n"
-      "    mov  r6, dpl                         \n" // low 8-bit
-      "    mov  r7, dph                         \n" // high 8-bit
-      "    clr  c                               \n"
-      "    mov  a,#0x00                         \n"
-      "    subb a, r6                           \n"
-      "    clr  a                               \n"
-      "    subb a, r7                           \n"
-      "    jc skip_0us$                         \n"
-      "    ret                                  \n" // return if 0 us,about
-                                                    // 0.85us total
-      "    nop                                  \n"
-      "skip_0us$:                               \n"
-      "    clr  c                               \n"
-      "    mov  a, #0x01                        \n"
-      "    subb a, r6                           \n"
-      "    mov  r6, a                           \n"
-      "    mov  a, #0x00                        \n"
-      "    subb a, r7                           \n"
-      "    mov  r7, a                           \n"
-      "    jc skip_1us$                         \n"
-      "    ret                                  \n" // return if 1 us,
-                                                    // about 1.25 us total
-      "    nop                                  \n" // adjust alignment
-
-      "loop32m_us$:                             \n" // about nus
-      "    nop \n nop \n nop \n nop \n nop \n    "  // 6+19 cycle
-      "    nop \n "
-      "loop32m_us_2$:                          \n" // need more test
-      "    nop \n nop \n nop \n nop \n nop \n    "
-      "skip_1us$:                              \n" // 1st loop shorter than
-                                                   // others
-      "    nop \n nop \n nop \n nop \n nop \n    "
-      "    nop \n nop \n nop \n nop \n nop \n    "
-      "    nop \n nop \n nop \n nop \n           "
-      "    inc  r6                              \n" // 1 cycle
-      "    cjne r6, #0,loop32m_us$              \n" // 6 cycle
-      "    inc  r7                              \n" // there will be extra 1
-                                                    // cycles for every 256us
-      "    cjne r7, #0,loop32m_us_2$            \n"
-      "    nop                                  \n");
-#elif F_CPU >= 24000000UL
-  __asm__(
-      ".even                                    \n"
-      "    mov  r6, dpl                         \n" // low 8-bit
-      "    mov  r7, dph                         \n" // high 8-bit
-      "    clr  c                               \n"
-      "    mov  a,#0x01                         \n"
-      "    subb a, r6                           \n"
-      "    clr  a                               \n"
-      "    subb a, r7                           \n"
-      "    jc skip_0us$                         \n"
-      "    ret                                  \n" // return if 0 1 us
-                                                    // about 1.2us total
-      "    nop                                  \n"
-      "skip_0us$:                               \n"
-      "    clr  c                               \n" // do some loop init, not
-                                                    // useful for 2us but better
-                                                    // here
-      "    mov  a, #0x02                        \n"
-      "    subb a, r6                           \n"
-      "    mov  r6, a                           \n"
-      "    mov  a, #0x00                        \n"
-      "    subb a, r7                           \n"
-      "    mov  r7, a                           \n"
-
-      "    nop                                  \n" // keep even
-      "    cjne r6,#0x00,loop24m_us$            \n"
-      "    cjne r7,#0x00,loop24m_us$            \n"
-      "    nop                                  \n"
-      "    ret                                  \n" // return if 2us  about 2 us
-                                                    // total
-
-      "loop24m_us$:                             \n" // about nus
-
-      "    nop \n nop \n nop \n nop \n nop \n    " // 6+11 cycle
-      "    nop \n "
-      "loop24m_us_2$:                          \n" // need more test
-
-      "    nop \n nop \n nop \n nop \n nop \n    "
-      "    nop \n nop \n nop \n nop \n nop \n    "
-      "    nop \n                                "
-
-      "    inc  r6                              \n" // 1 cycle
-      "    cjne r6, #0,loop24m_us$              \n" // 6 cycle
-      "    inc  r7                              \n" // there will be extra 1
-                                                    // cycles for every 256us
-      "    cjne r7, #0,loop24m_us_2$            \n"
-      "    nop                                  \n");
-#elif F_CPU >= 16000000UL
-  __asm__(
-      ".even                                    \n"
-      "    mov  r6, dpl                         \n" // low 8-bit
-      "    mov  r7, dph                         \n" // high 8-bit
-      "    clr  c                               \n"
-      "    mov  a,#0x01                         \n"
-      "    subb a, r6                           \n"
-      "    clr  a                               \n"
-      "    subb a, r7                           \n"
-      "    jc skip_0us$                         \n"
-      "    ret                                  \n" // return if 0 1 us
-                                                    // about 1.7us total
-      "    nop                                  \n"
-      "skip_0us$:                               \n"
-      "    cjne r7,#0x00,skip_2us$              \n"
-      "    cjne r6,#0x02,skip_2us$              \n"
-      "    ret                                  \n" // return if 2us about 2.3us
-                                                    // total
-      "    nop                                  \n" // keep even
-      "skip_2us$:                               \n"
-
-      "    clr  c                               \n" // do some loop init, not
-                                                    // useful for 3us but better
-                                                    // here
-      "    mov  a, #0x03                        \n"
-      "    subb a, r6                           \n"
-      "    mov  r6, a                           \n"
-      "    mov  a, #0x00                        \n"
-      "    subb a, r7                           \n"
-      "    mov  r7, a                           \n"
-
-      "    cjne r6,#0x00,loop16m_us$            \n"
-      "    cjne r7,#0x00,loop16m_us$            \n"
-      "    ret                                  \n" // return if 3us  about 3.4
-                                                    // us total
-
-      "loop16m_us$:                             \n" // about n.5us
-
-      "    nop \n nop \n nop \n nop \n nop \n    " // 6+3 cycle
-      "    nop \n                                "
-      "loop16m_us_2$:                          \n"
-      "    nop \n nop \n nop \n                  "
-
-      "    inc  r6                              \n" // 1 cycle
-      "    cjne r6, #0,loop16m_us$              \n" // 6 cycle
-      "    inc  r7                              \n" // there will be extra 1
-                                                    // cycles for every 256us
-      "    cjne r7, #0,loop16m_us_2$            \n");
-#elif F_CPU >= 12000000UL
-  __asm__(
-      ".even                                    \n"
-      "    mov  r6, dpl                         \n" // low 8-bit
-      "    mov  r7, dph                         \n" // high 8-bit
-      "    clr  c                               \n"
-      "    mov  a,#0x02                         \n"
-      "    subb a, r6                           \n"
-      "    clr  a                               \n"
-      "    subb a, r7                           \n"
-      "    jc skip_0us$                         \n"
-      "    ret                                  \n" // return if 0 1 2 us
-                                                    // about 2.25us total
-      "    nop                                  \n"
-      "skip_0us$:                               \n"
-      "    clr  c                               \n" // do some loop init, not
-                                                    // useful for 3us but better
-                                                    // here
-      "    mov  a, #0x03                        \n"
-      "    subb a, r6                           \n"
-      "    mov  r6, a                           \n"
-      "    mov  a, #0x00                        \n"
-      "    subb a, r7                           \n"
-      "    mov  r7, a                           \n"
-
-      "    nop                                  \n" // keep even
-      "    cjne r6,#0x00,loop12m_us$            \n"
-      "    cjne r7,#0x00,loop12m_us$            \n"
-      "    nop                                  \n"
-      "    ret                                  \n" // return if 3us  about 2 us
-                                                    // total
-
-      "loop12m_us$:                             \n" // about nus
-
-      "    nop \n nop \n nop \n nop \n nop \n    " //
-      "    nop \n "
-      "loop12m_us_2$:                          \n"  // need more test
-      "    inc  r6                              \n" // 1 cycle
-      "    cjne r6, #0,loop12m_us$              \n" // 6 cycle
-      "    inc  r7                              \n" // there will be extra 1
-                                                    // cycles for every 256us
-      "    cjne r7, #0,loop12m_us_2$            \n"
-      "    nop                                  \n");
-#else
-#error "clock not supported yet"
-
-#endif
-
-  // return takes 5~6 cycles, depending on even or odd address
+  __asm__(DELAY_US_ASM);
 }
 
 void init() {
@@ -1218,6 +349,10 @@ void init() {
   delayMicroseconds(5000); // needed to stablize internal RC
 
 #ifndef USER_USB_RAM
+  // Print_setStringWrite() is not reentrant, so it is called here before the
+  // USB interrupt is on, not from the bus reset handler
+  Print_setStringWrite((writefunc_p)USBSerial_write, USBSerial_writeStr);
+
   // init USB
   USBDeviceCfg();
   USBDeviceEndPointCfg(); //????
@@ -1232,9 +367,16 @@ void init() {
   PWM_CTRL = 0;
 
   // init T0 for millis
+#ifdef TIMER0_LOW_TICK_RATE
+  TMOD = (TMOD & ~0x0F) | (bT0_M0); // mode 1, free running 16 bit
+  T2MOD = T2MOD & ~bT0_CLK;         // bT0_CLK=0;clk Div by 12
+  TH0 = 0;
+  TL0 = 0;
+#else
   TMOD = (TMOD & ~0x0F) | (bT0_M1); // mode 2 for autoreload
   T2MOD = T2MOD & ~bT0_CLK;         // bT0_CLK=0;clk Div by 12
   TH0 = 255 - T0_CYCLE + 1;
+#endif
   TF0 = 0;
   ET0 = 1;
   TR0 = 1;
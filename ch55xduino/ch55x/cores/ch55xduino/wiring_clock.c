@@ -0,0 +1,326 @@
+// Changing the system clock at run time. Timer0 keeps its reload and counts
+// Fsys/12, so its ticks get longer or shorter with the clock. micros() and
+// millis() use the scaling generated for F_CPU until the first setClock();
+// after that they take the time at the last change and add the ticks counted
+// since then, scaled for the current clock. Software timers and sleeping
+// tasks have their deadlines converted to the new tick rate.
+//
+// The clock dividers of Serial0 (Timer1), Serial1, SPI0 and PWM are rescaled
+// in place. A running UART whose baud rate cannot be kept within about 2.5%
+// makes setClock() fail instead. Code timed by counting cycles for F_CPU
+// (delayMicroseconds(), WS2812, pulseIn) and USB only work right at the build
+// clock.
+
+#include "wiring_private.h"
+#include "wiring_timing.h"
+
+#if defined(CH551) || defined(CH552) || defined(CH549)
+#if F_EXT_OSC > 0
+#define CLOCK_PLL (F_EXT_OSC * 4UL)
+#else
+#define CLOCK_PLL 96000000UL
+#endif
+// Fsys = CLOCK_PLL / divider, for each MASK_SYS_CK_SEL value
+#if defined(CH549)
+__code uint16_t clockDividers[8] = {512, 128, 32, 8, 6, 4, 3, 2};
+#else
+__code uint16_t clockDividers[8] = {512, 128, 32, 16, 8, 6, 4, 3};
+#endif
+#define CLOCK_SERIAL1_MAX 256 // SBAUD1 counts up to 256
+#elif defined(CH559)
+#if F_EXT_OSC > 0
+#define CLOCK_OSC F_EXT_OSC
+#else
+#define CLOCK_OSC 12000000UL
+#endif
+// Fsys = Fpll / Ksys, Ksys 1~32. The PLL also clocks USB, it is left alone.
+#define CLOCK_PLL ((uint32_t)CLOCK_OSC * (PLL_CFG & MASK_PLL_MULT))
+#define CLOCK_MAX 56000000UL
+#define CLOCK_SERIAL1_MAX 0xFFFF // SER1_DLM:SER1_DLL
+#endif
+
+__xdata uint32_t clockFrequency = F_CPU;
+
+// the time at the last clock change, and the tick count it was taken at
+__xdata uint32_t clockUsBase = 0;
+__xdata uint32_t clockMsBase = 0;
+__xdata uint64_t clockUs64Base = 0;
+__xdata uint64_t clockMs64Base = 0;
+__xdata uint32_t clockTicksHi = 0;
+__xdata uint16_t clockTicksLo = 0;
+
+// 1 tick = (clockMsMul / clockMsDiv) ms, timer0UsMul / timer0UsDiv for us
+__xdata uint16_t clockMsMul = T0_MS_MUL;
+__xdata uint16_t clockMsDiv = T0_MS_DIV;
+
+// ticks since the last clock change, as hi:lo, set by clockReadTicks()
+__data uint32_t clockHi;
+__data uint16_t clockLo;
+
+static void clockReadTicks(void) {
+#ifdef TIMER0_LOW_TICK_RATE
+  TIMER0_READ_TICKS(clockHi, clockLo);
+#else
+  __data uint32_t count;
+  __data uint32_t part;
+  __data uint8_t count5;
+  __data uint8_t t;
+  __bit interruptOn = EA;
+
+  EA = 0;
+  count = timer0_overflow_count;
+  count5 = timer0_overflow_count_5th_byte;
+  t = TL0;
+  if (TF0 && (t < 255)) {
+    if (++count == 0) {
+      count5++;
+    }
+  }
+  EA = interruptOn;
+
+  // count * T0_CYCLE + the ticks since the last reload, 16 bits at a time
+  part = (count & 0xFFFF) * T0_CYCLE + (uint8_t)(t - (256 - T0_CYCLE));
+  clockHi = ((count >> 16) | ((uint32_t)count5 << 16)) * T0_CYCLE +
+            (part >> 16);
+  clockLo = part;
+#endif
+  clockHi -= clockTicksHi;
+  if (clockLo < clockTicksLo) {
+    clockHi--;
+  }
+  clockLo -= clockTicksLo;
+}
+
+static uint32_t clockSince(__data uint8_t inMillis) {
+  __data uint32_t hi = clockHi;
+  __data uint16_t lo = clockLo;
+
+  if (inMillis) {
+    TIMER0_SCALE_TICKS(hi, lo, clockMsMul, clockMsDiv);
+    return clockMsBase + hi;
+  }
+  TIMER0_SCALE_TICKS(hi, lo, timer0UsMul, timer0UsDiv);
+  return clockUsBase + hi;
+}
+
+static uint64_t clockSince64(__data uint8_t inMillis) {
+  __data uint64_t ticks = ((uint64_t)clockHi << 16) | clockLo;
+
+  if (inMillis) {
+    return clockMs64Base + ticks * clockMsMul / clockMsDiv;
+  }
+  return clockUs64Base + ticks * timer0UsMul / timer0UsDiv;
+}
+
+static uint32_t clockTime(__data uint8_t inMillis) {
+  clockReadTicks();
+  return clockSince(inMillis);
+}
+
+static uint64_t clockTime64(__data uint8_t inMillis) {
+  clockReadTicks();
+  return clockSince64(inMillis);
+}
+
+static uint32_t clockGcd(__data uint32_t a, __data uint32_t b) {
+  __data uint32_t t;
+
+  while (b) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// divider * oldDivider / newDivider, rounded. 0 when out of 1~max.
+__data uint16_t clockOldDivider;
+__data uint16_t clockNewDivider;
+
+static uint16_t clockRescale(__data uint16_t divider, __data uint16_t max) {
+  __data uint32_t x =
+      ((uint32_t)divider * clockOldDivider + clockNewDivider / 2) /
+      clockNewDivider;
+
+  if (x == 0 || x > max) {
+    return 0;
+  }
+  return x;
+}
+
+// A UART divider rescaled the same way. 0 also when the baud rate would end
+// up more than 1/40 (2.5%) off, a UART is unlikely to work then.
+static uint16_t clockRescaleUart(__data uint16_t divider, __data uint16_t max) {
+  __data uint32_t want = (uint32_t)divider * clockOldDivider;
+  __data uint32_t got = (uint32_t)clockRescale(divider, max) * clockNewDivider;
+
+  if ((got > want ? got - want : want - got) > want / 40) {
+    return 0;
+  }
+  return got / clockNewDivider;
+}
+
+// The Serial0 (Timer1) and Serial1 dividers for the new clock, 0 if unused.
+// They are worked out before anything changes, so setClock() can refuse a
+// clock that would break a running UART.
+__data uint16_t clockTimer1;
+__data uint16_t clockSerial1;
+
+static uint8_t clockUartDividers(void) {
+  __data uint16_t x;
+
+  // TH1 and SBAUD1 count up to 256, a reload of 0 is 256 counts
+  clockTimer1 = 0;
+  if (TR1) {
+    x = (uint8_t)(0 - TH1);
+    clockTimer1 = clockRescaleUart(x ? x : 256, 256);
+    if (clockTimer1 == 0) {
+      return 0;
+    }
+  }
+  clockSerial1 = 0;
+#if defined(CH559)
+  SER1_LCR |= bLCR_DLAB;
+  x = ((uint16_t)SER1_DLM << 8) | SER1_DLL;
+  SER1_LCR &= ~bLCR_DLAB;
+#else
+  x = SBAUD1 ? (uint8_t)(0 - SBAUD1) : 0; // SBAUD1 is 0 while unused
+#endif
+  if (x) {
+    clockSerial1 = clockRescaleUart(x, CLOCK_SERIAL1_MAX);
+    if (clockSerial1 == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// SPI0_CK_SE and PWM_CK_SE divide by their value, 0 is left alone
+#define CLOCK_RESCALE_DIV(reg)                                                 \
+  {                                                                            \
+    if (reg) {                                                                 \
+      __data uint16_t x = clockRescale(reg, 255);                              \
+      if (x) {                                                                 \
+        reg = x;                                                               \
+      }                                                                        \
+    }                                                                          \
+  }
+
+static void clockRescalePeripherals(void) {
+  if (clockTimer1) {
+    TH1 = 0 - clockTimer1;
+  }
+  if (clockSerial1) {
+#if defined(CH559)
+    SER1_LCR |= bLCR_DLAB;
+    SER1_DLM = clockSerial1 >> 8;
+    SER1_DLL = clockSerial1 & 0xff;
+    SER1_LCR &= ~bLCR_DLAB;
+#else
+    SBAUD1 = 0 - clockSerial1;
+#endif
+  }
+  CLOCK_RESCALE_DIV(SPI0_CK_SE);
+  CLOCK_RESCALE_DIV(PWM_CK_SE);
+}
+
+uint8_t setClock(__data uint32_t freq) {
+  __data uint8_t sel;
+  __data uint32_t g;
+  __data uint32_t msG;
+  __bit interruptOn;
+
+  if (freq == clockFrequency) {
+    return 1;
+  }
+
+#if defined(CH559)
+  if (freq > CLOCK_MAX || CLOCK_PLL % freq) {
+    return 0;
+  }
+  g = CLOCK_PLL / freq;
+  if (g > 32) {
+    return 0;
+  }
+  sel = g & MASK_SYS_CK_DIV; // 32 is written as 0
+  clockNewDivider = g;
+#else
+  for (sel = 0; sel < 8; sel++) {
+    if (CLOCK_PLL / clockDividers[sel] == freq &&
+        CLOCK_PLL % clockDividers[sel] == 0) {
+      break;
+    }
+  }
+  if (sel == 8) {
+    return 0;
+  }
+  clockNewDivider = clockDividers[sel];
+#endif
+  clockOldDivider = CLOCK_PLL / clockFrequency;
+
+  // 1 tick = 12 / Fsys s, the ratios have to fit TIMER0_SCALE_TICKS
+  g = clockGcd(12000000UL, freq);
+  msG = clockGcd(12000UL, freq);
+  if (12000000UL / g > 0xFFFF || freq / msG > 0xFFFF) {
+    return 0;
+  }
+  if (!clockUartDividers()) {
+    return 0;
+  }
+
+  // software timers and sleeping tasks wait for a Timer0 overflow count, they
+  // keep the time left in us while the tick rate changes
+  if (softTimerClockHook != NULL) {
+    softTimerClockHook(0);
+  }
+  if (taskClockHook != NULL) {
+    taskClockHook(0);
+  }
+
+  interruptOn = EA;
+  EA = 0;
+
+  // rebase micros() and millis() on the tick count of this moment
+  clockReadTicks();
+  clockUs64Base = clockSince64(0);
+  clockMs64Base = clockSince64(1);
+  clockUsBase = clockSince(0);
+  clockMsBase = clockSince(1);
+  clockTicksLo += clockLo;
+  clockTicksHi += clockHi;
+  if (clockTicksLo < clockLo) {
+    clockTicksHi++;
+  }
+
+  SAFE_MOD = 0x55;
+  SAFE_MOD = 0xAA;
+#if defined(CH559)
+  CLOCK_CFG = CLOCK_CFG & ~MASK_SYS_CK_DIV | sel;
+#else
+  CLOCK_CFG = CLOCK_CFG & ~MASK_SYS_CK_SEL | sel;
+#endif
+  SAFE_MOD = 0x00;
+
+  clockRescalePeripherals();
+
+  timer0UsMul = 12000000UL / g;
+  timer0UsDiv = freq / g;
+  clockMsMul = 12000UL / msG;
+  clockMsDiv = freq / msG;
+  clockFrequency = freq;
+
+  timer0TimeHook = clockTime;
+  timer0Time64Hook = clockTime64;
+
+  EA = interruptOn;
+
+  if (softTimerClockHook != NULL) {
+    softTimerClockHook(1);
+  }
+  if (taskClockHook != NULL) {
+    taskClockHook(1);
+  }
+  return 1;
+}
+
+uint32_t getClock(void) { return clockFrequency; }
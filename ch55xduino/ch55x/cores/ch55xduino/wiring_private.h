@@ -11,6 +11,62 @@
 
 typedef void (*voidFuncPtr)(void);
 
+uint32_t timer0_overflows(void);
+uint32_t timer0_usToOverflows(__data uint32_t us);
+uint32_t timer0_overflowsToUs(__data uint32_t count);
+
+// 1 Timer0 tick in us, T0_US_MUL / T0_US_DIV until setClock() changes it
+extern __xdata uint16_t timer0UsMul;
+extern __xdata uint16_t timer0UsDiv;
+
+// setClock() calls these with after = 0 before the clock changes and with
+// after = 1 once it has, so deadlines in Timer0 overflows can be converted
+typedef void (*clockChangeFuncPtr)(__data uint8_t after);
+extern __xdata clockChangeFuncPtr softTimerClockHook;
+extern __xdata clockChangeFuncPtr taskClockHook;
+
+extern __idata volatile uint32_t timer0_overflow_count;
+extern __idata volatile uint8_t timer0_overflow_count_5th_byte;
+
+// micros()/millis() (inMillis = 0/1) and their 64 bit versions, when the
+// clock was changed at run time
+typedef uint32_t (*timer0TimeFuncPtr)(__data uint8_t inMillis);
+typedef uint64_t (*timer0Time64FuncPtr)(__data uint8_t inMillis);
+extern __data timer0TimeFuncPtr timer0TimeHook;
+extern __xdata timer0Time64FuncPtr timer0Time64Hook;
+
+// hi:lo = overflow count:TH0:TL0, read with interrupts off. A pending TF0 only
+// counts if the 16 bit value was read after the overflow.
+#define TIMER0_READ_TICKS(hi, lo)                                              \
+  {                                                                            \
+    __data uint8_t th;                                                         \
+    __bit interruptOn = EA;                                                    \
+    EA = 0;                                                                    \
+    do {                                                                       \
+      th = TH0;                                                                \
+      lo = TL0;                                                                \
+    } while (th != TH0);                                                       \
+    hi = timer0_overflow_count;                                                \
+    if (TF0 && !(th & 0x80)) {                                                 \
+      hi++;                                                                    \
+    }                                                                          \
+    EA = interruptOn;                                                          \
+    lo |= (uint16_t)th << 8;                                                   \
+  }
+
+// hi = (hi:lo * mul) / div, as two 16 bit long division steps so 32 bit math
+// is enough. Exact as long as hi:lo * mul fits in 48 bits, and for ever when
+// div is a power of 2.
+#define TIMER0_SCALE_TICKS(hi, lo, mul, div)                                   \
+  {                                                                            \
+    __data uint32_t part = (uint32_t)(lo) * (mul);                             \
+    hi = hi * (mul) + (part >> 16);                                            \
+    lo = part;                                                                 \
+    part = hi / (div);                                                         \
+    lo = ((((hi - part * (div)) << 16) | lo) / (div));                         \
+    hi = (part << 16) + lo;                                                    \
+  }
+
 #define EXTERNAL_INT_0 0
 #define EXTERNAL_INT_1 1
 
@@ -0,0 +1,156 @@
+// Profiling regions. Timestamps are the Timer0 tick count micros() reads, so
+// the resolution is one tick of F_CPU/12 (12 cycles) and nothing extra runs in
+// the interrupt. Times are kept in ticks and printed as cycles.
+
+#include "wiring_private.h"
+#include "wiring_timing.h"
+
+#ifndef PROFILE_REGIONS
+#define PROFILE_REGIONS 4
+#endif
+#define PROFILE_BUCKETS 8
+
+#ifdef TIMER0_LOW_TICK_RATE
+#define T0_PERIOD 65536UL
+#else
+#define T0_PERIOD T0_CYCLE
+#endif
+
+extern __idata volatile uint32_t timer0_overflow_count;
+
+__xdata uint32_t profileStartCount[PROFILE_REGIONS];
+__xdata uint16_t profileStartLow[PROFILE_REGIONS];
+__xdata uint16_t profileCalls[PROFILE_REGIONS];
+__xdata uint32_t profileMin[PROFILE_REGIONS];
+__xdata uint32_t profileMax[PROFILE_REGIONS];
+__xdata uint32_t profileTotal[PROFILE_REGIONS];
+// bucket i counts times under 64 << 2i cycles, the last one the rest
+__xdata uint16_t profileHistogram[PROFILE_REGIONS][PROFILE_BUCKETS];
+__xdata uint32_t profileOverhead;
+__bit profileCalibrated = 0;
+
+__data uint32_t profileCount;
+__data uint16_t profileLow;
+
+// profileCount:profileLow = overflow count:ticks since the last overflow
+static void profileRead(void) {
+#ifdef TIMER0_LOW_TICK_RATE
+  __data uint8_t th;
+#endif
+  __bit interruptOn = EA;
+
+  EA = 0;
+#ifdef TIMER0_LOW_TICK_RATE
+  do {
+    th = TH0;
+    profileLow = TL0;
+  } while (th != TH0);
+  profileCount = timer0_overflow_count;
+  if (TF0 && !(th & 0x80)) {
+    profileCount++;
+  }
+  EA = interruptOn;
+  profileLow |= (uint16_t)th << 8;
+#else
+  profileLow = TL0;
+  profileCount = timer0_overflow_count;
+  if (TF0 && (profileLow < 255)) {
+    profileCount++;
+  }
+  EA = interruptOn;
+  profileLow = (uint8_t)(profileLow - (256 - T0_CYCLE));
+#endif
+}
+
+static uint32_t profileElapsed(__data uint8_t id) {
+  __data uint32_t ticks;
+
+  profileRead();
+  ticks = (profileCount - profileStartCount[id]) * T0_PERIOD + profileLow -
+          profileStartLow[id];
+  return ticks > profileOverhead ? ticks - profileOverhead : 0;
+}
+
+void Profile_reset(void) {
+  memset(profileCalls, 0, sizeof(profileCalls));
+  memset(profileHistogram, 0, sizeof(profileHistogram));
+  // an empty region, so results only count the code between the macros
+  profileCalibrated = 1;
+  profileOverhead = 0;
+  Profile_begin(0);
+  profileOverhead = profileElapsed(0);
+}
+
+void Profile_begin(__data uint8_t id) {
+  if (!profileCalibrated) {
+    Profile_reset();
+  }
+  if (id < PROFILE_REGIONS) {
+    profileRead();
+    profileStartCount[id] = profileCount;
+    profileStartLow[id] = profileLow;
+  }
+}
+
+void Profile_end(__data uint8_t id) {
+  __data uint32_t ticks;
+  __data uint32_t bound;
+  __data uint8_t bucket;
+
+  if (id >= PROFILE_REGIONS) {
+    return;
+  }
+  ticks = profileElapsed(id);
+  if (profileCalls[id] == 0 || ticks < profileMin[id]) {
+    profileMin[id] = ticks;
+  }
+  if (profileCalls[id] == 0 || ticks > profileMax[id]) {
+    profileMax[id] = ticks;
+  }
+  if (profileCalls[id] == 0) {
+    profileTotal[id] = 0;
+  }
+  profileTotal[id] += ticks;
+  if (profileCalls[id] != 0xFFFF) {
+    profileCalls[id]++;
+  }
+  // 64 cycles is 64 / 12 ticks, compare ticks * 12 to stay exact
+  ticks *= 12;
+  for (bucket = 0, bound = 64; bucket < PROFILE_BUCKETS - 1; bucket++) {
+    if (ticks < bound) {
+      break;
+    }
+    bound <<= 2;
+  }
+  if (profileHistogram[id][bucket] != 0xFFFF) {
+    profileHistogram[id][bucket]++;
+  }
+}
+
+void Profile_dump(__data writefunc_p writefunc) {
+  __xdata uint8_t id;
+  __xdata uint8_t bucket;
+
+  Print_print_s(writefunc, "id calls min max avg (cycles) "
+                           "<64 <256 <1k <4k <16k <64k <256k more");
+  Print_println(writefunc);
+  for (id = 0; id < PROFILE_REGIONS; id++) {
+    if (profileCalls[id] == 0) {
+      continue;
+    }
+    Print_print_u(writefunc, id);
+    writefunc(' ');
+    Print_print_u(writefunc, profileCalls[id]);
+    writefunc(' ');
+    Print_print_u(writefunc, profileMin[id] * 12);
+    writefunc(' ');
+    Print_print_u(writefunc, profileMax[id] * 12);
+    writefunc(' ');
+    Print_print_u(writefunc, profileTotal[id] / profileCalls[id] * 12);
+    for (bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+      writefunc(' ');
+      Print_print_u(writefunc, profileHistogram[id][bucket]);
+    }
+    Print_println(writefunc);
+  }
+}
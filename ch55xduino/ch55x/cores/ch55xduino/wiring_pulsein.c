@@ -19,6 +19,8 @@ uint16_t digitalReadDirectLutAddrAndCarryReturn(uint8_t pin);
   #define F_CPU_MHZ 32
 #elif F_CPU == 56000000
   #define F_CPU_MHZ 56
+#elif F_CPU == 48000000
+  #define F_CPU_MHZ 48
 #endif
 
 #define STR_INDIR(x) #x
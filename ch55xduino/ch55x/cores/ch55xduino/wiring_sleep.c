@@ -0,0 +1,25 @@
+// Power down until an external event. The CH55x has no idle mode that keeps
+// the timers running: PD in PCON stops the system clock, Timer0 included, and
+// only the sources enabled in WAKE_CTRL (USB, RXD low, some pins) wake it up.
+// millis() and micros() do not count the time spent asleep.
+
+#include "wiring_private.h"
+
+void sleepUntilWake(__data uint8_t wakeSources) {
+  if (wakeSources == 0) {
+    return; // nothing could ever wake it up
+  }
+
+  // let the byte being shifted out on UART0 finish
+  while (XBUS_AUX & bUART0_TX)
+    ;
+
+  SAFE_MOD = 0x55;
+  SAFE_MOD = 0xAA;
+  WAKE_CTRL = wakeSources;
+  PCON |= PD; // cleared by the wake-up hardware, code continues here
+  SAFE_MOD = 0x55;
+  SAFE_MOD = 0xAA;
+  WAKE_CTRL = 0x00;
+  SAFE_MOD = 0x00;
+}
@@ -0,0 +1,109 @@
+// Cooperative tasks. Up to 8 stackless tasks, one bit each in taskReady, the
+// task id is also its priority (0 runs first). yield() runs every ready task
+// once, so a task that keeps polling cannot starve the ones after it. Sleeping
+// tasks wait on the Timer0 overflow count, like software timers, and
+// setClock() converts their wake times the same way.
+
+#include "wiring_private.h"
+
+extern __data voidFuncPtr taskRunHook;
+
+__xdata voidFuncPtr taskFunc[TASK_SLOTS];
+__xdata uint32_t taskWake[TASK_SLOTS];
+__data uint8_t taskReady = 0;
+__data uint8_t taskSleeping = 0;
+__data uint8_t taskCurrent;
+
+void task_run(void) {
+  __data uint32_t now;
+  __data uint8_t mask;
+  __bit interruptOn;
+
+  if (taskSleeping) {
+    now = timer0_overflows();
+    for (taskCurrent = 0, mask = 1; mask; taskCurrent++, mask <<= 1) {
+      if ((taskSleeping & mask) &&
+          (int32_t)(now - taskWake[taskCurrent]) >= 0) {
+        interruptOn = EA;
+        EA = 0;
+        taskSleeping &= ~mask;
+        taskReady |= mask;
+        EA = interruptOn;
+      }
+    }
+  }
+  for (taskCurrent = 0, mask = 1; mask; taskCurrent++, mask <<= 1) {
+    if (taskReady & mask) {
+      taskFunc[taskCurrent]();
+    }
+  }
+}
+
+// like softTimerClock(), for the wake times of sleeping tasks
+static void taskClock(__data uint8_t after) {
+  __data uint32_t now = timer0_overflows();
+  __data uint8_t i;
+
+  for (i = 0; i < TASK_SLOTS; i++) {
+    if (!(taskSleeping & (1 << i))) {
+      continue;
+    }
+    if (after) {
+      taskWake[i] = now + timer0_usToOverflows(taskWake[i]);
+    } else {
+      taskWake[i] = (int32_t)(taskWake[i] - now) > 0
+                        ? timer0_overflowsToUs(taskWake[i] - now)
+                        : 0;
+    }
+  }
+}
+
+static void taskClear(__data uint8_t mask) {
+  __bit interruptOn = EA;
+  EA = 0;
+  taskReady &= ~mask;
+  taskSleeping &= ~mask;
+  EA = interruptOn;
+}
+
+void task_start(__data uint8_t id, __xdata voidFuncPtr func) {
+  if (id < TASK_SLOTS) {
+    taskClear(1 << id);
+    taskFunc[id] = func;
+    taskRunHook = task_run;
+    taskClockHook = taskClock;
+    task_ready(id);
+  }
+}
+
+void task_stop(__data uint8_t id) {
+  if (id < TASK_SLOTS) {
+    taskClear(1 << id);
+  }
+}
+
+// Called from main() (task_start) and from interrupts. Reentrant, so an
+// interrupt cannot overwrite the id of the call it interrupted, and the two
+// updates are one critical section, SDCC saves and restores EA around it.
+// A slot that was never started has no function for task_run() to call.
+void task_ready(uint8_t id) __reentrant {
+  if (id < TASK_SLOTS && taskFunc[id] != NULL) {
+    __critical {
+      taskSleeping &= ~(1 << id);
+      taskReady |= 1 << id;
+    }
+  }
+}
+
+void task_suspend(void) { taskClear(1 << taskCurrent); }
+
+void task_sleep(__data uint32_t us) {
+  __data uint8_t mask = 1 << taskCurrent;
+  __bit interruptOn;
+  taskWake[taskCurrent] = timer0_overflows() + timer0_usToOverflows(us);
+  interruptOn = EA;
+  EA = 0;
+  taskReady &= ~mask;
+  taskSleeping |= mask;
+  EA = interruptOn;
+}
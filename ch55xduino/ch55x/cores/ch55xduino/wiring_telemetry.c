@@ -0,0 +1,97 @@
+// Binary telemetry records. A record is a type byte, a sequence number, the
+// values (little endian) and the CRC-16/CCITT-FALSE of all of them, COBS
+// encoded and ended by a 0x00 byte. COBS leaves no zero inside the frame, so
+// the receiver resynchronizes at the next 0x00 after a lost byte, and the
+// encoded frame goes to the output's string write (see Print_setStringWrite)
+// in one call. util/telemetry_decode.py decodes them on the PC. Not for use
+// from interrupts.
+
+#include "Arduino.h"
+
+#ifndef TELEMETRY_SIZE
+#define TELEMETRY_SIZE 32 // bytes of values in one record
+#endif
+
+#if TELEMETRY_SIZE > 248
+#error "TELEMETRY_SIZE must fit one COBS block, 248 bytes at most"
+#endif
+
+// [0] COBS code, [1] type, [2] sequence, values, 2 CRC bytes, string end
+__xdata uint8_t telemetryFrame[TELEMETRY_SIZE + 6];
+__xdata uint8_t telemetryLength;
+__xdata uint8_t telemetrySequence = 0;
+__xdata writefunc_p telemetryTarget;
+__bit telemetryOverflow;
+
+void Telemetry_begin(__data writefunc_p writefunc, __data uint8_t type) {
+  telemetryTarget = writefunc;
+  telemetryFrame[1] = type;
+  telemetryFrame[2] = telemetrySequence;
+  telemetryLength = 3;
+  telemetryOverflow = 0;
+}
+
+void Telemetry_u8(__data uint8_t v) {
+  if (telemetryLength == TELEMETRY_SIZE + 3) {
+    telemetryOverflow = 1;
+    return;
+  }
+  telemetryFrame[telemetryLength++] = v;
+}
+
+void Telemetry_u16(__data uint16_t v) {
+  Telemetry_u8(v & 0xFF);
+  Telemetry_u8(v >> 8);
+}
+
+void Telemetry_u32(__data uint32_t v) {
+  Telemetry_u16(v & 0xFFFF);
+  Telemetry_u16(v >> 16);
+}
+
+void Telemetry_f(__data float v) {
+  // the IEEE-754 bits, read back with struct "<f" on the PC
+  __xdata union {
+    float f;
+    uint32_t bits;
+  } value;
+
+  value.f = v;
+  Telemetry_u32(value.bits);
+}
+
+uint8_t Telemetry_end(void) {
+  __data uint16_t crc = 0xFFFF;
+  __data uint8_t i;
+  __data uint8_t x;
+  __data uint8_t next;
+
+  if (telemetryOverflow) {
+    return 0; // more values than TELEMETRY_SIZE, nothing is sent
+  }
+
+  // CRC-16/CCITT-FALSE (0x1021), a byte at a time without a table
+  for (i = 1; i < telemetryLength; i++) {
+    x = (crc >> 8) ^ telemetryFrame[i];
+    x ^= x >> 4;
+    crc = (crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x;
+  }
+  telemetryFrame[telemetryLength++] = crc & 0xFF;
+  telemetryFrame[telemetryLength++] = crc >> 8;
+
+  // COBS in place: the code byte in front and every zero become the distance
+  // to the next zero, or to the end of the frame
+  next = telemetryLength;
+  i = telemetryLength;
+  while (i--) {
+    if (i == 0 || telemetryFrame[i] == 0) {
+      telemetryFrame[i] = next - i;
+      next = i;
+    }
+  }
+  telemetryFrame[telemetryLength] = 0;
+
+  telemetrySequence++;
+  x = Print_print_s(telemetryTarget, (char *)telemetryFrame);
+  return x + telemetryTarget(0);
+}
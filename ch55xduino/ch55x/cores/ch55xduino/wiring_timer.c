@@ -0,0 +1,116 @@
+// Software timers. Deadlines are kept in Timer0 overflow ticks, the counter
+// Timer0Interrupt already maintains, so the interrupt does no extra work and
+// checking for due timers is a 4 byte compare instead of a millis() call.
+// Callbacks run from main() after loop(), never from an interrupt. setClock()
+// converts the deadlines when the overflow rate changes.
+
+#include "wiring_private.h"
+
+#ifndef SOFT_TIMER_SLOTS
+#define SOFT_TIMER_SLOTS 4
+#endif
+
+extern __data voidFuncPtr softTimerPollHook;
+
+__xdata voidFuncPtr softTimerCallback[SOFT_TIMER_SLOTS];
+__xdata uint32_t softTimerDue[SOFT_TIMER_SLOTS];
+__xdata uint32_t softTimerPeriod[SOFT_TIMER_SLOTS]; // 0 for one-shot
+__data uint32_t softTimerNext;
+__bit softTimerBusy = 0;
+
+void softTimer_poll(void) {
+  __data uint32_t now = timer0_overflows();
+  __data uint8_t i;
+  voidFuncPtr callback;
+
+  if ((int32_t)(now - softTimerNext) < 0 || softTimerBusy) {
+    return;
+  }
+  softTimerBusy = 1;
+  // callbacks may start timers, those pull softTimerNext in as well
+  softTimerNext = now + 0x7FFFFFFF;
+  for (i = 0; i < SOFT_TIMER_SLOTS; i++) {
+    callback = softTimerCallback[i];
+    if (callback == NULL) {
+      continue;
+    }
+    if ((int32_t)(now - softTimerDue[i]) >= 0) {
+      if (softTimerPeriod[i]) {
+        softTimerDue[i] += softTimerPeriod[i];
+        if ((int32_t)(now - softTimerDue[i]) >= 0) {
+          // fell behind by a whole period, skip instead of bursting
+          softTimerDue[i] = now + softTimerPeriod[i];
+        }
+      } else {
+        softTimerCallback[i] = NULL;
+      }
+      callback();
+    }
+    if (softTimerCallback[i] != NULL &&
+        (int32_t)(softTimerDue[i] - softTimerNext) < 0) {
+      softTimerNext = softTimerDue[i];
+    }
+  }
+  softTimerBusy = 0;
+}
+
+// setClock() changes how long an overflow is: the time left and the periods
+// are held in us while it does and turned back into overflows after it
+static void softTimerClock(__data uint8_t after) {
+  __data uint32_t now = timer0_overflows();
+  __data uint8_t i;
+
+  for (i = 0; i < SOFT_TIMER_SLOTS; i++) {
+    if (softTimerCallback[i] == NULL) {
+      continue;
+    }
+    if (after) {
+      softTimerDue[i] = now + timer0_usToOverflows(softTimerDue[i]);
+      if (softTimerPeriod[i]) {
+        softTimerPeriod[i] = timer0_usToOverflows(softTimerPeriod[i]);
+      }
+    } else {
+      softTimerDue[i] = (int32_t)(softTimerDue[i] - now) > 0
+                            ? timer0_overflowsToUs(softTimerDue[i] - now)
+                            : 0;
+      softTimerPeriod[i] = timer0_overflowsToUs(softTimerPeriod[i]);
+    }
+  }
+  softTimerNext = now; // the next poll looks for the earliest deadline again
+}
+
+static uint8_t softTimerStart(uint32_t us, voidFuncPtr callback,
+                              uint8_t periodic) {
+  __data uint8_t i;
+  __data uint32_t ticks = timer0_usToOverflows(us);
+
+  for (i = 0; i < SOFT_TIMER_SLOTS; i++) {
+    if (softTimerCallback[i] == NULL) {
+      softTimerPeriod[i] = periodic ? ticks : 0;
+      softTimerDue[i] = timer0_overflows() + ticks;
+      if (softTimerPollHook == NULL ||
+          (int32_t)(softTimerDue[i] - softTimerNext) < 0) {
+        softTimerNext = softTimerDue[i];
+      }
+      softTimerCallback[i] = callback;
+      softTimerPollHook = softTimer_poll;
+      softTimerClockHook = softTimerClock;
+      return i;
+    }
+  }
+  return SOFT_TIMER_NONE;
+}
+
+uint8_t softTimer_every(__data uint32_t us, __xdata voidFuncPtr callback) {
+  return softTimerStart(us, callback, 1);
+}
+
+uint8_t softTimer_after(__data uint32_t us, __xdata voidFuncPtr callback) {
+  return softTimerStart(us, callback, 0);
+}
+
+void softTimer_stop(__data uint8_t id) {
+  if (id < SOFT_TIMER_SLOTS) {
+    softTimerCallback[id] = NULL;
+  }
+}
@@ -0,0 +1,1794 @@
+// This file is generated by generateTiming.py, do not edit.
+#ifndef _WIRING_TIMING_H_INCLUDED
+#define _WIRING_TIMING_H_INCLUDED
+
+// clang-format off
+#if F_CPU == 56000000
+#define T0_CYCLE 224
+#define T0_US_MUL 3
+#define T0_US_DIV 14
+#define T0_MS_MUL 3
+#define T0_MS_DIV 14000
+#define MICROS_SCALE_ASM \
+  ";1m = 224t 1t=3/14us, return (m*48+t*3/14)   \n" \
+  ";TL0 runs from 32 to 255, t=TL0-32           \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #32                              \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*3/14;                                   \n" \
+  "    mov a, r5                                \n" \
+  "    mov b, #14                               \n" \
+  "    div ab                                   \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r5, a                                \n" \
+  "    mov a, r6                                \n" \
+  "    mov b, #3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov b, #14                               \n" \
+  "    div ab                                   \n" \
+  "    add a, r5                                \n" \
+  "    mov r5, a                                \n" \
+  ";m=m*48;                                     \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 6/125ms, return m*6/125                \n" \
+  "    mov b, #6                                \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r5, b                                \n" \
+  "    mov b, #6                                \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r5                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r5, a                                \n" \
+  "    mov b, #6                                \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r5                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r5, a                                \n" \
+  "    mov b, #6                                \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r5                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r5, a                                \n" \
+  "    mov b, #6                                \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r5                                \n" \
+  "    mov r4, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r5, a                                \n" \
+  "    mov r7, #125                             \n" \
+  "    mov a, r5                                \n" \
+  "    mov b, r7                                \n" \
+  "    div ab                                   \n" \
+  "    mov r5, b                                \n" \
+  "    mov b, #40                               \n" \
+  ";r0~r4=r0~r5/125, bit by bit                 \n" \
+  "1$:                                          \n" \
+  "    clr c                                    \n" \
+  "    mov a, r0                                \n" \
+  "    rlc a                                    \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    rlc a                                    \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    rlc a                                    \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, r3                                \n" \
+  "    rlc a                                    \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r4                                \n" \
+  "    rlc a                                    \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r5                                \n" \
+  "    rlc a                                    \n" \
+  "    mov r5, a                                \n" \
+  "    mov f0, c                                \n" \
+  "    clr c                                    \n" \
+  "    subb a, r7                               \n" \
+  ";1 for this bit on shift overflow or non negative subb\n" \
+  "    jb f0, 2$                                \n" \
+  "    jc 3$                                    \n" \
+  "2$:                                          \n" \
+  "    mov r5, a                                \n" \
+  "    inc r0                                   \n" \
+  "3$:                                          \n" \
+  "    djnz b, 1$                               \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 1us = 56 cycles, 1 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=n-1, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #1                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    mov r5, #8                               \n" \
+  "6$:                                          \n" \
+  "    djnz r5, 6$                              \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n"
+#elif F_CPU == 48000000
+#define T0_CYCLE 250
+#define T0_US_MUL 1
+#define T0_US_DIV 4
+#define T0_MS_MUL 1
+#define T0_MS_DIV 4000
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=1/4us, return (m*125+t*1/2)>>1 \n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*1/2;                                    \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r5, a                                \n" \
+  ";m=m*125;                                    \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r4, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  ";m=m>>1;                                     \n" \
+  "    clr c                                    \n" \
+  "    mov a, r4                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r3                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, r0                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r0, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 1/16ms, return (m*16)>>8               \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 1us = 48 cycles, 1 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=n-1, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #1                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    mov r5, #7                               \n" \
+  "6$:                                          \n" \
+  "    djnz r5, 6$                              \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n"
+#elif F_CPU == 32000000
+#define T0_CYCLE 250
+#define T0_US_MUL 3
+#define T0_US_DIV 8
+#define T0_MS_MUL 3
+#define T0_MS_DIV 8000
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=3/8us, return (m*24000+t*96)>>8\n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*96;                                     \n" \
+  "    mov b, #96                               \n" \
+  "    mov a, r5                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r5, a                                \n" \
+  "    mov r7, b                                \n" \
+  ";m=m*24000;                                  \n" \
+  "    mov b, #192                              \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r3                                \n" \
+  "    mov b, #93                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r4                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #192                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r4                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    mov b, #93                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #192                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    mov b, #93                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #192                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r0                                \n" \
+  "    mov b, #93                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #192                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 3/32ms, return (m*24)>>8               \n" \
+  "    mov b, #24                               \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #24                               \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #24                               \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #24                               \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #24                               \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 1us = 32 cycles, 2 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=n-2, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #2                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    mov r5, #4                               \n" \
+  "6$:                                          \n" \
+  "    djnz r5, 6$                              \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    mov r5, #3                               \n" \
+  "7$:                                          \n" \
+  "    djnz r5, 7$                              \n" \
+  "    nop                                      \n"
+#elif F_CPU == 24000000
+#define T0_CYCLE 250
+#define T0_US_MUL 1
+#define T0_US_DIV 2
+#define T0_MS_MUL 1
+#define T0_MS_DIV 2000
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=1/2us, return (m*125+t*1/2)    \n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*1/2;                                    \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r5, a                                \n" \
+  ";m=m*125;                                    \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #125                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 1/8ms, return (m*32)>>8                \n" \
+  "    mov b, #32                               \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #32                               \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #32                               \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #32                               \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #32                               \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 1us = 24 cycles, 2 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=n-2, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #2                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    mov r5, #3                               \n" \
+  "6$:                                          \n" \
+  "    djnz r5, 6$                              \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n"
+#elif F_CPU == 16000000
+#define T0_CYCLE 250
+#define T0_US_MUL 3
+#define T0_US_DIV 4
+#define T0_MS_MUL 3
+#define T0_MS_DIV 4000
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=3/4us, return (m*48000+t*192)>>8\n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*192;                                    \n" \
+  "    mov b, #192                              \n" \
+  "    mov a, r5                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r5, a                                \n" \
+  "    mov r7, b                                \n" \
+  ";m=m*48000;                                  \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r3                                \n" \
+  "    mov b, #187                              \n" \
+  "    mul ab                                   \n" \
+  "    add a, r4                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r4                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    mov b, #187                              \n" \
+  "    mul ab                                   \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    mov b, #187                              \n" \
+  "    mul ab                                   \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov a, r0                                \n" \
+  "    mov b, #187                              \n" \
+  "    mul ab                                   \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r4                               \n" \
+  "    mov r4, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 3/16ms, return (m*48)>>8               \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #48                               \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 1us = 16 cycles, 3 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=n-3, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #3                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n"
+#elif F_CPU == 12000000
+#define T0_CYCLE 250
+#define T0_US_MUL 1
+#define T0_US_DIV 1
+#define T0_MS_MUL 1
+#define T0_MS_DIV 1000
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=1us, return (m*250+t*1)        \n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*1;                                      \n" \
+  ";m=m*250;                                    \n" \
+  "    mov b, #250                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #250                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #250                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #250                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 1/4ms, return (m*64)>>8                \n" \
+  "    mov b, #64                               \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #64                               \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #64                               \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #64                               \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #64                               \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 1us = 12 cycles, 4 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=n-4, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #4                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n"
+#elif F_CPU == 6000000
+#define T0_CYCLE 250
+#define T0_US_MUL 2
+#define T0_US_DIV 1
+#define T0_MS_MUL 1
+#define T0_MS_DIV 500
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=2us, return (m*500+t*2)        \n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*2;                                      \n" \
+  "    mov b, #2                                \n" \
+  "    mov a, r5                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r5, a                                \n" \
+  "    mov r7, b                                \n" \
+  ";m=m*500;                                    \n" \
+  "    mov b, #244                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #244                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #244                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r0                                \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #244                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 1/2ms, return (m*128)>>8               \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r4                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r4, a                                \n" \
+  "    mov dpl, r1                              \n" \
+  "    mov dph, r2                              \n" \
+  "    mov b, r3                                \n" \
+  "    mov a, r4                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 2us = 12 cycles, 6 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=(us+1)>>1;                                \n" \
+  "    clr c                                    \n" \
+  "    mov a, r7                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r7, a                                \n" \
+  "    mov a, r6                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r6, a                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  ";n=n-6, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    mov r5, #2                               \n" \
+  "7$:                                          \n" \
+  "    djnz r5, 7$                              \n" \
+  "    nop                                      \n"
+#elif F_CPU == 3000000
+#define T0_CYCLE 250
+#define T0_US_MUL 4
+#define T0_US_DIV 1
+#define T0_MS_MUL 1
+#define T0_MS_DIV 250
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=4us, return (m*1000+t*4)       \n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*4;                                      \n" \
+  "    mov b, #4                                \n" \
+  "    mov a, r5                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r5, a                                \n" \
+  "    mov r7, b                                \n" \
+  ";m=m*1000;                                   \n" \
+  "    mov b, #232                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    mov b, #3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #232                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    mov b, #3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #232                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r0                                \n" \
+  "    mov b, #3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #232                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 1ms, return m*1                        \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 4us = 12 cycles, 6 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=(us+2)>>2;                                \n" \
+  "    clr c                                    \n" \
+  "    mov a, r7                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r7, a                                \n" \
+  "    mov a, r6                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r6, a                                \n" \
+  "    clr c                                    \n" \
+  "    mov a, r7                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r7, a                                \n" \
+  "    mov a, r6                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r6, a                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  ";n=n-6, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n"
+#elif F_CPU == 750000
+#define T0_CYCLE 250
+#define T0_US_MUL 16
+#define T0_US_DIV 1
+#define T0_MS_MUL 2
+#define T0_MS_DIV 125
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=16us, return (m*4000+t*16)     \n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*16;                                     \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r5                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r5, a                                \n" \
+  "    mov r7, b                                \n" \
+  ";m=m*4000;                                   \n" \
+  "    mov b, #160                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    mov b, #15                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #160                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    mov b, #15                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #160                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r0                                \n" \
+  "    mov b, #15                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #160                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 4ms, return m*4                        \n" \
+  "    mov b, #4                                \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #4                                \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #4                                \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #4                                \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 16us = 12 cycles, 9 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=(us+8)>>4;                                \n" \
+  "    mov r5, #4                               \n" \
+  "1$:                                          \n" \
+  "    clr c                                    \n" \
+  "    mov a, r7                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r7, a                                \n" \
+  "    mov a, r6                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r6, a                                \n" \
+  "    djnz r5, 1$                              \n" \
+  "    addc a, #0                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  ";n=n-9, done if n<=0;                        \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #9                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n"
+#elif F_CPU == 187500
+#define T0_CYCLE 250
+#define T0_US_MUL 64
+#define T0_US_DIV 1
+#define T0_MS_MUL 8
+#define T0_MS_DIV 125
+#define MICROS_SCALE_ASM \
+  ";1m = 250t 1t=64us, return (m*16000+t*64)    \n" \
+  ";TL0 runs from 6 to 255, t=TL0-6             \n" \
+  "    clr c                                    \n" \
+  "    mov a, r5                                \n" \
+  "    subb a, #6                               \n" \
+  "    mov r5, a                                \n" \
+  ";t=t*64;                                     \n" \
+  "    mov b, #64                               \n" \
+  "    mov a, r5                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r5, a                                \n" \
+  "    mov r7, b                                \n" \
+  ";m=m*16000;                                  \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r2                                \n" \
+  "    mov b, #62                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r3                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r1                                \n" \
+  "    mov b, #62                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r2                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov a, r0                                \n" \
+  "    mov b, #62                               \n" \
+  "    mul ab                                   \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  "    mov b, #128                              \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, b                                 \n" \
+  "    add a, r1                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";m=m+t;                                      \n" \
+  "    mov a, r5                                \n" \
+  "    add a, r0                                \n" \
+  "    mov r0, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, r1                               \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r2                               \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, r3                               \n" \
+  "    mov r3, a                                \n" \
+  ";return                                      \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define MILLIS_SCALE_ASM \
+  ";1m = 16ms, return m*16                      \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r0                                \n" \
+  "    mul ab                                   \n" \
+  "    mov r0, a                                \n" \
+  "    mov r6, b                                \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r1                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r1, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r2                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r2, a                                \n" \
+  "    clr a                                    \n" \
+  "    addc a, b                                \n" \
+  "    mov r6, a                                \n" \
+  "    mov b, #16                               \n" \
+  "    mov a, r3                                \n" \
+  "    mul ab                                   \n" \
+  "    add a, r6                                \n" \
+  "    mov r3, a                                \n" \
+  "    mov dpl, r0                              \n" \
+  "    mov dph, r1                              \n" \
+  "    mov b, r2                                \n" \
+  "    mov a, r3                                \n"
+#define DELAY_US_ASM \
+  ";1 pass = 64us = 12 cycles, 11 passes for the call\n" \
+  "    .even                                    \n" \
+  "    mov r6, dpl                              \n" \
+  "    mov r7, dph                              \n" \
+  ";n=(us+32)>>6;                               \n" \
+  "    mov r5, #6                               \n" \
+  "1$:                                          \n" \
+  "    clr c                                    \n" \
+  "    mov a, r7                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r7, a                                \n" \
+  "    mov a, r6                                \n" \
+  "    rrc a                                    \n" \
+  "    mov r6, a                                \n" \
+  "    djnz r5, 1$                              \n" \
+  "    addc a, #0                               \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  ";n=n-11, done if n<=0;                       \n" \
+  "    clr c                                    \n" \
+  "    mov a, r6                                \n" \
+  "    subb a, #11                              \n" \
+  "    mov r6, a                                \n" \
+  "    mov a, r7                                \n" \
+  "    subb a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    jnc 2$                                   \n" \
+  "    ret                                      \n" \
+  "2$:                                          \n" \
+  "    orl a, r6                                \n" \
+  "    jnz 3$                                   \n" \
+  "    ret                                      \n" \
+  "3$:                                          \n" \
+  ";djnz counts r6 passes, then r7-1 times 256, so r7++ if r6!=0\n" \
+  "    mov a, r6                                \n" \
+  "    add a, #255                              \n" \
+  "    mov a, r7                                \n" \
+  "    addc a, #0                               \n" \
+  "    mov r7, a                                \n" \
+  "    nop                                      \n" \
+  "4$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "5$:                                          \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n" \
+  "    djnz r6, 4$                              \n" \
+  "    djnz r7, 5$                              \n" \
+  "    nop                                      \n" \
+  "    nop                                      \n"
+#else
+#error "clock not supported yet"
+#endif
+// clang-format on
+
+#endif
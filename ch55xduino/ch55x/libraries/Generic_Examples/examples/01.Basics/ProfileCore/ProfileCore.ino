@@ -0,0 +1,50 @@
+/*
+  Profile core functions
+
+  Times digitalWrite(), analogRead() and printing a number with the
+  PROFILE_BEGIN()/PROFILE_END() macros, and prints the results to USB serial
+  every 5 seconds:
+
+    id calls min max avg (cycles) <64 <256 <1k <4k <16k <64k <256k more
+
+  followed by one line of numbers for each region.
+  Times are in system clock cycles with a resolution of 12 cycles. The last 8
+  columns are a histogram: how many times each region took under 64, under
+  256, ... cycles. Interrupts that hit a region are counted in its time.
+
+  The circuit:
+  - Use the onboard LED at P3.3.
+
+  This example code is in the public domain.
+*/
+
+#define LED_BUILTIN 33
+
+uint32_t lastDump = 0;
+
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+}
+
+void loop() {
+  PROFILE_BEGIN(0);
+  digitalWrite(LED_BUILTIN, HIGH);
+  PROFILE_END(0);
+  digitalWrite(LED_BUILTIN, LOW);
+
+  PROFILE_BEGIN(1);
+  analogRead(11);
+  PROFILE_END(1);
+
+  PROFILE_BEGIN(2);
+  Print_print_ub(USBSerial_write, millis(), HEX);
+  PROFILE_END(2);
+  USBSerial_println("");
+
+  if (millis() - lastDump >= 5000) {
+    lastDump = millis();
+    Profile_dump(USBSerial_write);
+    Profile_reset();
+  }
+  delay(5);
+}
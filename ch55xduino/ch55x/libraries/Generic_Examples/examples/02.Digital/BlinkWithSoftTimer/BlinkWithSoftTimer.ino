@@ -0,0 +1,40 @@
+/*
+  Blink with a software timer
+
+  Same as BlinkWithoutDelay, but the core calls toggleLed() every half second,
+  so loop() does not have to check millis().
+
+  softTimer_every() and softTimer_after() run their callbacks from main(),
+  after loop() returns. Keep loop() short for accurate timing. Up to 4 timers
+  can run at once.
+
+  The circuit:
+  - Use the onboard LED at P3.3.
+
+  This example code is in the public domain.
+*/
+
+#define LED_BUILTIN 33
+
+uint8_t ledState = LOW;
+uint8_t blinkTimer;
+
+void toggleLed() {
+  ledState = !ledState;
+  digitalWrite(LED_BUILTIN, ledState);
+}
+
+void stopBlinking() {
+  softTimer_stop(blinkTimer);
+  digitalWrite(LED_BUILTIN, LOW);
+}
+
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+  blinkTimer = softTimer_every(500000, toggleLed); // every 0.5 s
+  softTimer_after(60000000, stopBlinking);         // once, after one minute
+}
+
+void loop() {
+  // other work goes here
+}
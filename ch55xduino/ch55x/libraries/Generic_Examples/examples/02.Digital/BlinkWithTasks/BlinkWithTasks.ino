@@ -0,0 +1,51 @@
+/*
+  Blink with tasks
+
+  Two cooperative tasks run next to loop(): one blinks the LED, the other
+  reads a button and pauses the blinking while it is pressed. Tasks run after
+  every loop() and while delay() waits, so the LED keeps blinking during the
+  delay() in loop().
+
+  Tasks are stackless. Local variables are lost at TASK_SLEEP(), TASK_YIELD()
+  and TASK_WAIT_UNTIL(), use static variables instead.
+
+  The circuit:
+  - Use the onboard LED at P3.3.
+  - Pushbutton between P3.2 and GND.
+
+  This example code is in the public domain.
+*/
+
+#define LED_BUILTIN 33
+#define BUTTON_PIN 32
+
+bool paused = false;
+
+void blinkTask() {
+  TASK_BEGIN();
+  TASK_WAIT_UNTIL(!paused);
+  digitalWrite(LED_BUILTIN, HIGH);
+  TASK_SLEEP(250000);
+  digitalWrite(LED_BUILTIN, LOW);
+  TASK_SLEEP(250000);
+  TASK_END();
+}
+
+void buttonTask() {
+  TASK_BEGIN();
+  paused = (digitalRead(BUTTON_PIN) == LOW);
+  TASK_SLEEP(20000); // debounce
+  TASK_END();
+}
+
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  task_start(0, buttonTask);
+  task_start(1, blinkTask);
+}
+
+void loop() {
+  // other work goes here, delay() lets the tasks run
+  delay(1000);
+}
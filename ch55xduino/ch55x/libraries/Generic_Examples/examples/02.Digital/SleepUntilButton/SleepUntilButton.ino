@@ -0,0 +1,34 @@
+/*
+  Sleep until button
+
+  Powers the chip down between button presses. Each press on P1.4 wakes it
+  up, and the LED blinks once before the chip goes back to sleep. While
+  asleep the clock is stopped, so millis() does not advance.
+
+  The circuit:
+  - Use the onboard LED at P3.3.
+  - Pushbutton between P1.4 and GND. Not P3.2 (INT0): its wake-up source
+    also wakes the chip while P3.3 is low, and the LED pin is low here.
+
+  This example code is in the public domain.
+*/
+
+#define LED_BUILTIN 33
+#define BUTTON_PIN 14
+
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+}
+
+void loop() {
+  digitalWrite(LED_BUILTIN, HIGH);
+  delay(200);
+  digitalWrite(LED_BUILTIN, LOW);
+
+  // wait for the button to be released, then sleep until the next press
+  while (digitalRead(BUTTON_PIN) == LOW)
+    ;
+  delay(20); // debounce
+  sleepUntilWake(bWAK_P1_4_LO);
+}
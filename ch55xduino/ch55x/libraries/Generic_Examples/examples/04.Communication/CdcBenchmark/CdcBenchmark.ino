@@ -0,0 +1,107 @@
+/*
+  CdcBenchmark
+
+  Measures how fast USB serial moves data. Run cdc_benchmark.py from this
+  folder on the computer, it sends the commands below and reports bytes/s
+  and round trip latency.
+
+  Commands, counts are 4 bytes little-endian:
+  'V'         reply "CDCBENCH1\n"
+  'I' count   send count bytes, byte k is k % 64
+  'O' count   receive count bytes with the same pattern, reply 'K' or 'E'
+  'E' count   echo count bytes back
+  'P'         reply 'P' right away
+
+  created 2026
+  for use with CH55xduino
+
+  This example code is in the public domain.
+
+*/
+
+//These are fairly large arrays, store them in external memory with keyword __xdata
+__xdata uint8_t txBlock[64];
+__xdata uint8_t rxBlock[64];
+
+void setup() {
+  for (uint8_t i = 0; i < 64; i++) {
+    txBlock[i] = i;
+  }
+}
+
+uint8_t readByteWait() {
+  while (!USBSerial_available());
+  return USBSerial_read();
+}
+
+uint32_t readCount() {
+  uint32_t count = readByteWait();
+  count |= ((uint32_t)readByteWait()) << 8;
+  count |= ((uint32_t)readByteWait()) << 16;
+  count |= ((uint32_t)readByteWait()) << 24;
+  return count;
+}
+
+void bulkIn(uint32_t count) {
+  while (count >= 64) {
+    USBSerial_print_n(txBlock, 64);
+    count -= 64;
+  }
+  USBSerial_print_n(txBlock, count);
+  USBSerial_flush();
+}
+
+void bulkOut(uint32_t count) {
+  uint8_t expected = 0;
+  bool match = true;
+  while (count > 0) {
+    uint8_t len = USBSerial_readBytes(rxBlock, (count > 64) ? 64 : count);
+    for (uint8_t i = 0; i < len; i++) {
+      if (rxBlock[i] != expected) {
+        match = false;
+      }
+      expected = (expected + 1) & 63;
+    }
+    count -= len;
+  }
+  USBSerial_write(match ? 'K' : 'E');
+  USBSerial_flush();
+}
+
+void echo(uint32_t count) {
+  while (count > 0) {
+    uint8_t len = USBSerial_readBytes(rxBlock, (count > 64) ? 64 : count);
+    if (len > 0) {
+      USBSerial_print_n(rxBlock, len);
+      count -= len;
+    } else {
+      USBSerial_flush(); // nothing more yet, send what we have
+    }
+  }
+  USBSerial_flush();
+}
+
+void loop() {
+  if (USBSerial_available()) {
+    char cmd = USBSerial_read();
+    switch (cmd) {
+      case 'V':
+        USBSerial_print("CDCBENCH1\n");
+        USBSerial_flush();
+        break;
+      case 'I':
+        bulkIn(readCount());
+        break;
+      case 'O':
+        bulkOut(readCount());
+        break;
+      case 'E':
+        echo(readCount());
+        break;
+      case 'P':
+        USBSerial_write('P');
+        USBSerial_flush();
+        break;
+    }
+  }
+}
@@ -0,0 +1,192 @@
+#!/usr/bin/python
+
+# Host side of the CdcBenchmark example.
+#
+#   python cdc_benchmark.py /dev/ttyACM0
+#   python cdc_benchmark.py --emulate      (no board, Linux/macOS only)
+#
+# --emulate runs a copy of the sketch protocol on a pseudo terminal, so the
+# script itself can be checked without hardware. Its numbers only show the
+# pty speed of the computer.
+
+import argparse
+import json
+import os
+import struct
+import sys
+import threading
+import time
+
+import serial
+
+BANNER = b"CDCBENCH1\n"
+
+
+def pattern(count):
+    block = bytes(range(64))
+    return (block * (count // 64 + 1))[:count]
+
+
+def read_exact(port, count):
+    data = bytearray()
+    while len(data) < count:
+        chunk = port.read(count - len(data))
+        if not chunk:
+            raise RuntimeError(f"timeout, got {len(data)} of {count} bytes")
+        data += chunk
+    return bytes(data)
+
+
+def bench_in(port, count):
+    start = time.perf_counter()
+    port.write(b"I" + struct.pack("<I", count))
+    data = read_exact(port, count)
+    elapsed = time.perf_counter() - start
+    if data != pattern(count):
+        raise RuntimeError("bulk in: data mismatch")
+    return count / elapsed
+
+
+def bench_out(port, count):
+    start = time.perf_counter()
+    port.write(b"O" + struct.pack("<I", count) + pattern(count))
+    reply = read_exact(port, 1)
+    elapsed = time.perf_counter() - start
+    if reply != b"K":
+        raise RuntimeError("bulk out: device saw a data mismatch")
+    return count / elapsed
+
+
+def bench_echo(port, count):
+    payload = pattern(count)
+    result = {}
+
+    def reader():
+        try:
+            result["data"] = read_exact(port, count)
+        except RuntimeError as e:
+            result["error"] = e
+
+    start = time.perf_counter()
+    thread = threading.Thread(target=reader)
+    thread.start()
+    port.write(b"E" + struct.pack("<I", count))
+    for i in range(0, count, 64):
+        port.write(payload[i:i + 64])
+    thread.join()
+    elapsed = time.perf_counter() - start
+    if "error" in result:
+        raise result["error"]
+    if result["data"] != payload:
+        raise RuntimeError("echo: data mismatch")
+    return count / elapsed
+
+
+def bench_ping(port, rounds):
+    times = []
+    for _ in range(rounds):
+        start = time.perf_counter()
+        port.write(b"P")
+        if read_exact(port, 1) != b"P":
+            raise RuntimeError("ping: bad reply")
+        times.append((time.perf_counter() - start) * 1e6)
+    times.sort()
+
+    def percentile(p):
+        return times[min(len(times) - 1, int(len(times) * p / 100))]
+
+    return {"p50_us": percentile(50), "p90_us": percentile(90),
+            "p99_us": percentile(99), "max_us": times[-1]}
+
+
+def emulate():
+    # Same protocol as CdcBenchmark.ino, served on the master side of a pty
+    import tty
+    master, slave = os.openpty()
+    tty.setraw(slave)
+
+    def read_n(n):
+        data = bytearray()
+        while len(data) < n:
+            chunk = os.read(master, n - len(data))
+            if not chunk:
+                raise EOFError
+            data += chunk
+        return bytes(data)
+
+    def serve():
+        try:
+            while True:
+                cmd = read_n(1)
+                if cmd == b"V":
+                    os.write(master, BANNER)
+                elif cmd == b"P":
+                    os.write(master, b"P")
+                elif cmd in (b"I", b"O", b"E"):
+                    count = struct.unpack("<I", read_n(4))[0]
+                    if cmd == b"I":
+                        data = pattern(count)
+                        for i in range(0, count, 64):
+                            os.write(master, data[i:i + 64])
+                    elif cmd == b"O":
+                        match = read_n(count) == pattern(count)
+                        os.write(master, b"K" if match else b"E")
+                    else:
+                        while count > 0:
+                            chunk = os.read(master, min(count, 64))
+                            os.write(master, chunk)
+                            count -= len(chunk)
+        except (EOFError, OSError):
+            pass
+
+    threading.Thread(target=serve, daemon=True).start()
+    return os.ttyname(slave)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="CH55xduino USB serial benchmark")
+    parser.add_argument("port", nargs="?", help="serial port of the board")
+    parser.add_argument("--emulate", action="store_true",
+                        help="run against a pty copy of the sketch")
+    parser.add_argument("--size", type=int, default=256 * 1024,
+                        help="bytes per bulk test (default 262144)")
+    parser.add_argument("--pings", type=int, default=1000,
+                        help="ping-pong rounds (default 1000)")
+    parser.add_argument("--json", action="store_true",
+                        help="print one JSON object, for tracking results")
+    args = parser.parse_args()
+
+    if args.emulate:
+        device = emulate()
+    elif args.port:
+        device = args.port
+    else:
+        parser.error("give a serial port or --emulate")
+
+    port = serial.Serial(device, baudrate=115200, timeout=5)
+    port.reset_input_buffer()
+    port.write(b"V")
+    if read_exact(port, len(BANNER)) != BANNER:
+        sys.exit("CdcBenchmark sketch not found on " + device)
+
+    results = {
+        "bulk_in_Bps": bench_in(port, args.size),
+        "bulk_out_Bps": bench_out(port, args.size),
+        "echo_Bps": bench_echo(port, args.size),
+        "ping": bench_ping(port, args.pings),
+    }
+    port.close()
+
+    if args.json:
+        print(json.dumps(results))
+    else:
+        print(f"bulk in:  {results['bulk_in_Bps']:12.0f} bytes/s")
+        print(f"bulk out: {results['bulk_out_Bps']:12.0f} bytes/s")
+        print(f"echo:     {results['echo_Bps']:12.0f} bytes/s")
+        ping = results["ping"]
+        print(f"ping:     p50 {ping['p50_us']:.0f} us, p90 {ping['p90_us']:.0f} us, "
+              f"p99 {ping['p99_us']:.0f} us, max {ping['max_us']:.0f} us")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,35 @@
+/*
+  Telemetry
+
+  Sends the analog input P1.1 and the time as binary records over USB serial,
+  instead of as text. A record is a few bytes with a CRC, so many more of them
+  fit through the port than printed lines.
+
+  Read them on the computer with util/telemetry_decode.py from the ch55xduino
+  repository:
+
+    python telemetry_decode.py /dev/ttyACM0 --record 1:BI
+
+  "1:BI" tells it that records of type 1 hold a uint8_t and a uint32_t. It
+  prints one line per record, and at the end how many were lost or damaged.
+
+  The circuit:
+  - any analog input sensor attached to analog in pin P1.1
+
+  This example code is in the public domain.
+*/
+
+__xdata uint8_t reading;
+__xdata uint32_t now;
+
+void setup() {
+  // No need to init USBSerial
+}
+
+void loop() {
+  reading = analogRead(11);
+  now = micros();
+  USBSerial_telemetry(1, reading, now);
+  USBSerial_flush();
+  delay(2);
+}
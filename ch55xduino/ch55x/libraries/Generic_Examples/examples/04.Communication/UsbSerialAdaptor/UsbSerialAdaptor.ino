@@ -6,6 +6,13 @@
 
   Baudrate of Serial0 is determined by USB serial's rate.
 
+  For high baud rates pick "CDC as USB-UART bridge (Serial0)" in
+  USB Settings instead. The core then relays bytes in the interrupts,
+  follows parity and stop bits too, and this sketch is not needed.
+  Bytes from Serial0 are dropped when the host does not read them in time,
+  USBSerial_bridgeDropped() counts them. Baud rates the UART cannot make
+  within about 3% are ignored and the old rate is kept.
+
   created 2020
   by Deqing Sun for use with CH55xduino
 
@@ -32,7 +39,7 @@ void loop() {
 
   __xdata uint32_t currentBaudRate = *((__xdata uint32_t *)LineCoding); //both linecoding and sdcc are little-endian
 
-  if (oldBaudRate != currentBaudRate) {
+  if (oldBaudRate != currentBaudRate && currentBaudRate != 0) {
     oldBaudRate = currentBaudRate;
     Serial0_begin(currentBaudRate);
   }
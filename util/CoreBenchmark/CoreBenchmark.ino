@@ -0,0 +1,138 @@
+/*
+  Core benchmark
+
+  Times core functions with Timer2 and prints one "name ticks" line per
+  function on Serial0, between a "BENCH <F_CPU>" and an "END" line.
+  ucsim_benchmark.py runs it in the ucsim s51 simulator and collects the
+  results, it also runs on a real board at 115200 baud.
+
+  Timer2 counts F_CPU/12 on the chip, and machine cycles in ucsim. Interrupts
+  are off while timing, and the cost of an empty measurement is subtracted.
+  Times over 65535 ticks are printed as "overflow". Blank lines are ignored.
+
+  The circuit: No external hardware needed.
+
+  This example code is in the public domain.
+*/
+
+#include <WS2812.h>
+
+#if defined(CH551) || defined(CH552)
+// in directGpioLut, not declared in a header
+void digitalWriteHighDirectLut(uint8_t pin);
+#endif
+
+#define LED_PIN 33
+
+__xdata uint8_t ledData[3 * 3];
+__xdata uint16_t overhead = 0;
+__xdata uint32_t sink;
+__xdata float temperature = 12.3;
+__xdata uint16_t humidity = 45;
+
+// formats numbers without the cost of a serial port
+uint8_t nullWrite(__data uint8_t c) {
+  c;
+  return 1;
+}
+
+// the same, taking whole strings, for the two line printing styles
+uint8_t lineWrite(__data uint8_t c) {
+  c;
+  return 1;
+}
+
+uint8_t lineWriteStr(char *str) {
+  __data uint8_t n = 0;
+  while (*str++)
+    n++;
+  return n;
+}
+
+void report(char *name) {
+  __xdata uint16_t ticks = ((uint16_t)TH2 << 8) | TL2;
+
+  Serial0_print_s(name);
+  Serial0_print_c(' ');
+  if (TF2) {
+    Serial0_println_s("overflow");
+  } else {
+    Serial0_println_u(ticks - overhead);
+  }
+}
+
+// clang-format off
+#define MEASURE(name, code) \
+  { \
+    Serial0_flush(); \
+    EA = 0; \
+    TL2 = 0; \
+    TH2 = 0; \
+    TF2 = 0; \
+    TR2 = 1; \
+    code; \
+    TR2 = 0; \
+    EA = 1; \
+    report(name); \
+  }
+// clang-format on
+
+void setup() {
+  Serial0_begin(115200);
+  pinMode(LED_PIN, OUTPUT);
+
+  // Timer2 as a free running 16 bit counter of F_CPU/12, no interrupt
+  ET2 = 0;
+  T2CON = 0;
+  T2MOD &= ~bT2_CLK;
+  RCAP2L = 0;
+  RCAP2H = 0;
+
+  // overhead of MEASURE itself
+  Serial0_flush();
+  EA = 0;
+  TL2 = 0;
+  TH2 = 0;
+  TR2 = 1;
+  TR2 = 0;
+  EA = 1;
+  overhead = ((uint16_t)TH2 << 8) | TL2;
+
+  Print_setStringWrite(lineWrite, lineWriteStr);
+
+  Serial0_print_s("BENCH ");
+  Serial0_println_u(F_CPU);
+
+  MEASURE("empty", );
+  MEASURE("digitalWrite", digitalWrite(LED_PIN, HIGH));
+#if defined(CH551) || defined(CH552)
+  MEASURE("digitalWriteHighDirectLut", digitalWriteHighDirectLut(LED_PIN));
+#endif
+  MEASURE("pinMode", pinMode(LED_PIN, OUTPUT));
+  MEASURE("micros", sink = micros());
+  MEASURE("millis", sink = millis());
+  MEASURE("delayMicroseconds_10", delayMicroseconds(10));
+  MEASURE("delayMicroseconds_100", delayMicroseconds(100));
+  MEASURE("delayMicroseconds_1000", delayMicroseconds(1000));
+  MEASURE("Print_print_u", Print_print_u(nullWrite, 1234567890));
+  MEASURE("Print_print_fd", Print_print_fd(nullWrite, 3.14159, 4));
+  // "T=12.30 H=45\r\n" as separate prints and as one Print_printAll()
+  MEASURE("print_chained", (Print_print_s(lineWrite, "T="),
+                            Print_print_f(lineWrite, temperature),
+                            Print_print_s(lineWrite, " H="),
+                            Print_print_u(lineWrite, humidity),
+                            Print_println(lineWrite)));
+  MEASURE("Print_printAll", Print_printAll(lineWrite, "T=", temperature, " H=",
+                                           humidity, "\r\n"));
+  // the same two values as a binary record
+  MEASURE("Telemetry_send",
+          Telemetry_send(lineWrite, 1, temperature, humidity));
+  MEASURE("Serial0_write", Serial0_write('\n'));
+  MEASURE("random", sink = random(1000));
+  // 3 LEDs, 72 bits
+  MEASURE("WS2812_72bits", neopixel_show_P1_5(ledData, sizeof(ledData)));
+
+  Serial0_println_s("END");
+}
+
+void loop() {}
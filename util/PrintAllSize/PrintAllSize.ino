@@ -0,0 +1,28 @@
+/*
+  Code size of one status line printed to Serial0, as separate prints and as
+  one Serial0_printAll(). util/ucsim_benchmark.py --size builds it both ways,
+  the chained version with -DPRINT_CHAINED.
+*/
+
+__xdata float temperature = 12.3;
+__xdata uint16_t humidity = 45;
+__xdata int8_t offset = -7;
+
+void setup() {
+  Serial0_begin(9600);
+}
+
+void loop() {
+#ifdef PRINT_CHAINED
+  Serial0_print_s("T=");
+  Serial0_print_f(temperature);
+  Serial0_print_s(" H=");
+  Serial0_print_u(humidity);
+  Serial0_print_c(' ');
+  Serial0_println_i(offset);
+#else
+  Serial0_printAll("T=", temperature, " H=", humidity, " ", offset, "\r\n");
+#endif
+  delay(1000);
+  humidity++;
+}
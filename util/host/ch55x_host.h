@@ -0,0 +1,42 @@
+// Force-included (gcc -include) when the core is built for the host by
+// host_build.py. Maps the SDCC keywords to plain C, so every SFR declared in
+// ch5xx.h becomes an ordinary global variable (built with -fcommon, so each
+// file's copy is the same one). Code under test reads and writes registers
+// like any other variable, and nothing happens behind its back: an interrupt
+// is a plain call to its handler.
+
+#ifndef CH55X_HOST_H
+#define CH55X_HOST_H
+
+// every libc header Arduino.h uses, before the macros below can touch them
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// long random(long) in WMath.c, not the libc one
+#define random ch55x_random
+
+#define __data
+#define __idata
+#define __xdata
+#define __pdata
+#define __code const
+#define __bit bool
+#define __at(addr)
+#define __interrupt(vector)
+#define __using(bank)
+#define __critical
+#define __nonbanked
+#define __reentrant
+#define __naked
+#define __sfr volatile uint8_t
+#define __sbit volatile bool
+#define __sfr16 volatile uint16_t
+#define __sfr32 volatile uint32_t
+// the only inline assembly left in the files built is the bootloader jump
+#define __asm__(code)
+
+#endif
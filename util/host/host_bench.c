@@ -0,0 +1,420 @@
+// Throughput of the portable core code, built for the host by host_build.py.
+// Each part first checks its output, so a faster version that prints the
+// wrong digits fails instead of winning. Interrupts are plain calls to their
+// handlers, registers are the globals from ch55x_host.h.
+//
+// long is 64 bit on the host and 32 bit on SDCC, so values stay in 32 bits.
+
+#include <time.h>
+
+#include "wiring_private.h"
+#include "TouchKey.h"
+
+static void usbHostIn(void);
+
+// from main.c and wiring.c, which are not built for the host. The core waits
+// in delayMicroseconds() for the host to take an IN packet, so it does.
+__xdata voidFuncPtr touchKeyHandler = NULL;
+void delayMicroseconds(__data uint16_t us) {
+  (void)us;
+  usbHostIn();
+}
+// USBhandler.c has it inline only, C99 wants one copy out of line
+void NOP_Process(void) {}
+
+// from the files under test, not in their headers
+extern volatile __bit uart0_flag_sending;
+void USB_EP0_SETUP(void);
+extern __xdata uint8_t Ep0Buffer[];
+void TouchKey_ISR_Handler(void);
+extern __xdata uint8_t channelEnabled;
+extern __xdata uint16_t touchBaseline[6];
+void resetCDCParameters(void);
+void setControlLineStateHandler(void);
+extern volatile __bit UpPoint2BusyFlag;
+extern __bit usbTxNeedZLP;
+#ifdef USB_CDC_RX_BUFFER_SIZE
+extern volatile __bit usbRxNakFlag;
+extern __xdata uint8_t Ep2Buffer[];
+void USB_EP2_OUT(void);
+#endif
+#ifdef CDC_TX_DOUBLE_BUFFER
+extern __xdata uint8_t Ep3Buffer[];
+void USB_EP3_IN(void);
+#endif
+
+static int failures = 0;
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, long count, double start) {
+  double elapsed = seconds() - start;
+  printf("%-28s %10.1f ns/op %12.0f op/s\n", name, elapsed * 1e9 / count,
+         count / elapsed);
+}
+
+static void check(int ok, const char *what, const char *got,
+                  const char *expected) {
+  if (!ok) {
+    printf("FAIL %s: got \"%s\", expected \"%s\"\n", what, got, expected);
+    failures++;
+  }
+}
+
+// Print_ output goes here
+static char out[64];
+static uint8_t outLen;
+
+static uint8_t bufWrite(__data uint8_t c) {
+  if (outLen < sizeof(out) - 1) {
+    out[outLen++] = c;
+    out[outLen] = 0;
+  }
+  return 1;
+}
+
+// the same buffer, filled a whole string at a time
+static uint8_t bufWriteStr(char *str) {
+  uint8_t n = 0;
+
+  while (*str && bufWrite(*str++))
+    n++;
+  return n;
+}
+
+static void binary(char *str, uint32_t n) {
+  int bits = 1;
+
+  while (bits < 32 && (n >> bits))
+    bits++;
+  while (bits--)
+    *str++ = '0' + ((n >> bits) & 1);
+  *str = 0;
+}
+
+static void printCheck(void) {
+  static const uint32_t values[] = {0, 1, 9, 10, 99, 100, 65535, 65536,
+                                    1234567890, 4294967295UL};
+  char expected[64];
+  unsigned int i;
+
+  for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    outLen = 0;
+    Print_print_u(bufWrite, values[i]);
+    snprintf(expected, sizeof(expected), "%lu", (unsigned long)values[i]);
+    check(strcmp(out, expected) == 0, "Print_print_u", out, expected);
+
+    outLen = 0;
+    Print_print_ub(bufWrite, values[i], HEX);
+    snprintf(expected, sizeof(expected), "%lX", (unsigned long)values[i]);
+    check(strcmp(out, expected) == 0, "Print_print_ub HEX", out, expected);
+
+    outLen = 0;
+    Print_print_ub(bufWrite, values[i], OCT);
+    snprintf(expected, sizeof(expected), "%lo", (unsigned long)values[i]);
+    check(strcmp(out, expected) == 0, "Print_print_ub OCT", out, expected);
+
+    outLen = 0;
+    Print_print_ub(bufWrite, values[i], BIN);
+    binary(expected, values[i]);
+    check(strcmp(out, expected) == 0, "Print_print_ub BIN", out, expected);
+
+    outLen = 0;
+    Print_print_i(bufWrite, -(long)(values[i] >> 1));
+    snprintf(expected, sizeof(expected), "%ld", -(long)(values[i] >> 1));
+    check(strcmp(out, expected) == 0, "Print_print_i", out, expected);
+  }
+  outLen = 0;
+  Print_print_ub(bufWrite, 100, 7);
+  check(strcmp(out, "202") == 0, "Print_print_ub base 7", out, "202");
+  // numbers sent through a registered string write
+  Print_setStringWrite(bufWrite, bufWriteStr);
+  outLen = 0;
+  Print_print_i(bufWrite, -1234567890L);
+  Print_println(bufWrite);
+  check(strcmp(out, "-1234567890\r\n") == 0, "Print_setStringWrite", out,
+        "-1234567890\\r\\n");
+  Print_setStringWrite(bufWrite, NULL);
+  outLen = 0;
+  Print_print_fd(bufWrite, 3.14159, 4);
+  check(strcmp(out, "3.1416") == 0, "Print_print_fd", out, "3.1416");
+  outLen = 0;
+  Print_print_fd(bufWrite, -0.5, 2);
+  check(strcmp(out, "-0.50") == 0, "Print_print_fd", out, "-0.50");
+  outLen = 0;
+  Print_print_fd(bufWrite, 1.999, 2);
+  check(strcmp(out, "2.00") == 0, "Print_print_fd rounding", out, "2.00");
+  outLen = 0;
+  Print_print_fd(bufWrite, 0.125, 2);
+  check(strcmp(out, "0.13") == 0, "Print_print_fd half", out, "0.13");
+  outLen = 0;
+  Print_print_fd(bufWrite, 5e9, 2);
+  check(strcmp(out, "ovf") == 0, "Print_print_fd ovf", out, "ovf");
+  outLen = 0;
+  Print_print_q(bufWrite, 0x18000L, 16, 2);
+  check(strcmp(out, "1.50") == 0, "Print_print_q", out, "1.50");
+  outLen = 0;
+  Print_print_q(bufWrite, -0x8000L, 16, 3);
+  check(strcmp(out, "-0.500") == 0, "Print_print_q", out, "-0.500");
+}
+
+static void printBench(void) {
+  long i;
+  double start;
+
+  start = seconds();
+  for (i = 0; i < 200000; i++) {
+    outLen = 0;
+    Print_print_u(bufWrite, (uint32_t)(i * 2654435761UL));
+  }
+  report("Print_print_u", i, start);
+
+  start = seconds();
+  for (i = 0; i < 200000; i++) {
+    outLen = 0;
+    Print_print_ub(bufWrite, (uint32_t)(i * 2654435761UL), HEX);
+  }
+  report("Print_print_ub HEX", i, start);
+
+  start = seconds();
+  for (i = 0; i < 50000; i++) {
+    outLen = 0;
+    Print_print_fd(bufWrite, i * 0.37, 3);
+  }
+  report("Print_print_fd", i, start);
+}
+
+// one float and one uint16_t as text and as a telemetry record
+static void telemetryBench(void) {
+  static const char expected[] = "0201010103484101032fb7" "00";
+  char got[sizeof(out) * 2 + 1];
+  long i;
+  double start;
+  uint8_t n;
+
+  outLen = 0;
+  n = Telemetry_send(bufWrite, 1, 12.5f, (uint16_t)0);
+  for (i = 0; i < outLen; i++)
+    snprintf(got + 2 * i, 3, "%02x", (uint8_t)out[i]);
+  got[2 * outLen] = 0;
+  check(n == outLen && strcmp(got, expected) == 0, "Telemetry_send", got,
+        expected);
+
+  start = seconds();
+  for (i = 0; i < 50000; i++) {
+    outLen = 0;
+    Print_print_fd(bufWrite, i * 0.37, 2);
+    bufWrite(' ');
+    Print_print_u(bufWrite, (uint16_t)i);
+    Print_println(bufWrite);
+  }
+  report("text line", i, start);
+
+  start = seconds();
+  for (i = 0; i < 50000; i++) {
+    outLen = 0;
+    Telemetry_send(bufWrite, 1, (float)(i * 0.37), (uint16_t)i);
+  }
+  report("Telemetry_send", i, start);
+}
+
+// Serial0: the sketch fills the TX ring, the TX interrupt drains it into SBUF
+static void serialBench(void) {
+  long i;
+  long sent = 0;
+  uint8_t expected = 0;
+  char got[8], want[8];
+  double start;
+
+  start = seconds();
+  for (i = 0; i < 1000000; i++) {
+    if (Serial0_availableForWrite() == 0) {
+      // transmit everything queued, one TX interrupt per byte
+      while (uart0_flag_sending) {
+        if (SBUF != expected) {
+          snprintf(got, sizeof(got), "%d", SBUF);
+          snprintf(want, sizeof(want), "%d", expected);
+          check(0, "Serial0 TX order", got, want);
+          return;
+        }
+        expected++;
+        sent++;
+        uart0IntTxHandler();
+      }
+    }
+    Serial0_write((uint8_t)i);
+  }
+  report("Serial0_write + TX irq", sent, start);
+
+  start = seconds();
+  for (i = 0; i < 1000000; i++) {
+    SBUF = (uint8_t)i;
+    uart0IntRxHandler();
+    if (Serial0_read() != (uint8_t)i) {
+      check(0, "Serial0 RX order", "", "");
+      return;
+    }
+  }
+  report("RX irq + Serial0_read", i, start);
+}
+
+// GET_DESCRIPTOR(device) through the standard request dispatch
+static void usbBench(void) {
+  static const uint8_t getDevice[8] = {0x80, USB_GET_DESCRIPTOR, 0, 1, 0, 0, 64,
+                                       0};
+  char got[8];
+  long i;
+  double start;
+
+  USB_RX_LEN = 8;
+  memcpy(Ep0Buffer, getDevice, 8);
+  USB_EP0_SETUP();
+  snprintf(got, sizeof(got), "%d", UEP0_T_LEN);
+  check(UEP0_T_LEN == 8 && Ep0Buffer[0] == 18 && Ep0Buffer[1] == 1,
+        "GET_DESCRIPTOR device length", got, "8");
+
+  start = seconds();
+  for (i = 0; i < 1000000; i++) {
+    memcpy(Ep0Buffer, getDevice, 8);
+    USB_EP0_SETUP();
+  }
+  report("USB_EP0_SETUP", i, start);
+}
+
+#ifdef CDC_TX_DOUBLE_BUFFER
+// the length and DMA address of each IN packet the host took
+static char usbInLog[64];
+static uint16_t usbInDma[8];
+static uint8_t usbInCount;
+#endif
+
+// The host takes the IN packet waiting on the endpoint, if there is one
+static void usbHostIn(void) {
+#ifdef CDC_TX_DOUBLE_BUFFER
+  size_t n = strlen(usbInLog);
+
+  if (!UpPoint2BusyFlag || (UEP3_CTRL & MASK_UEP_T_RES) != UEP_T_RES_ACK)
+    return;
+  snprintf(usbInLog + n, sizeof(usbInLog) - n, "%s%d", n ? " " : "",
+           UEP3_T_LEN);
+  if (usbInCount < 8)
+    usbInDma[usbInCount++] = UEP3_DMA;
+  USB_EP3_IN();
+#endif
+}
+
+#ifdef USB_CDC_RX_BUFFER_SIZE
+// OUT packets fill the ring until a whole packet no longer fits, then the
+// endpoint NAKs. Reading one byte makes room and ACKs again.
+static void usbRxCheck(void) {
+  char got[16], want[16];
+  int i, packets = 0;
+  int inOrder = 1;
+
+  resetCDCParameters();
+  UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_ACK;
+  U_TOG_OK = 1;
+  while ((UEP2_CTRL & MASK_UEP_R_RES) == UEP_R_RES_ACK && packets < 16) {
+    for (i = 0; i < 64; i++)
+      Ep2Buffer[i] = (uint8_t)(packets * 64 + i);
+    USB_RX_LEN = 64;
+    USB_EP2_OUT();
+    packets++;
+  }
+  snprintf(got, sizeof(got), "%d", packets);
+  snprintf(want, sizeof(want), "%d", USB_CDC_RX_BUFFER_SIZE / 64 - 1);
+  check(packets == USB_CDC_RX_BUFFER_SIZE / 64 - 1 && usbRxNakFlag,
+        "USB RX ring packets before NAK", got, want);
+
+  USBSerial_read();
+  check((UEP2_CTRL & MASK_UEP_R_RES) == UEP_R_RES_ACK && !usbRxNakFlag,
+        "USB RX ring ACK after a read", "NAK", "ACK");
+  for (i = 1; i < packets * 64; i++)
+    inOrder &= (uint8_t)USBSerial_read() == (uint8_t)i;
+  check(inOrder && USBSerial_available() == 0, "USB RX ring order", "", "");
+}
+#endif
+
+#ifdef CDC_TX_DOUBLE_BUFFER
+// Bytes written before a block go out first, then the block 64 bytes at a
+// time straight from its buffer, and a full last packet is followed by a ZLP
+// on the next flush.
+static void usbBlockCheck(void) {
+  static __xdata uint8_t block[128] __attribute__((aligned(2)));
+
+  resetCDCParameters();
+  Ep0Buffer[2] = 1; // DTR, the port is open
+  setControlLineStateHandler();
+  usbInLog[0] = 0;
+  usbInCount = 0;
+  USBSerial_write('a');
+  USBSerial_write('b');
+  USBSerial_write('c');
+  check(USBSerial_sendBlock(block, sizeof(block)) == 1, "USBSerial_sendBlock",
+        "0", "1");
+  while (USBSerial_blockBusy())
+    usbHostIn();
+  USBSerial_flush();
+  usbHostIn();
+  check(strcmp(usbInLog, "3 64 64 0") == 0, "USB block packets", usbInLog,
+        "3 64 64 0");
+  check(usbInCount == 4 && usbInDma[0] == (uint16_t)(uintptr_t)Ep3Buffer &&
+            memcmp(Ep3Buffer, "abc", 3) == 0 &&
+            usbInDma[1] == (uint16_t)(uintptr_t)block &&
+            usbInDma[2] == (uint16_t)(uintptr_t)(block + 64),
+        "USB block DMA addresses", "", "");
+  check(!UpPoint2BusyFlag && !usbTxNeedZLP, "USB idle after the block", "busy",
+        "idle");
+}
+#endif
+
+// TouchKey baseline filter on one channel, with a touch every 256 samples
+static void touchBench(void) {
+  long i;
+  double start;
+
+  channelEnabled = 1;
+  touchBaseline[0] = 1000;
+  TouchKey_SetMaxHalfDelta(5);
+  TouchKey_SetNoiseHalfDelta(2);
+  TouchKey_SetNoiseCountLimit(10);
+  TouchKey_SetFilterDelayLimit(5);
+  TouchKey_SetTouchThreshold(100);
+  TouchKey_SetReleaseThreshold(80);
+
+  start = seconds();
+  for (i = 0; i < 1000000; i++) {
+    TKEY_CTRL = 1;
+    TKEY_DAT = (i & 0x80) ? 850 : 1000 + (i & 3);
+    TouchKey_ISR_Handler();
+    TouchKey_Process();
+    if ((i & 0xFF) == 0xFF) {
+      check(TouchKey_Get() == 1, "TouchKey press", "0", "1");
+    }
+  }
+  report("TouchKey ISR + Process", i, start);
+}
+
+int main(void) {
+  printCheck();
+  printBench();
+  telemetryBench();
+  serialBench();
+  usbBench();
+#ifdef USB_CDC_RX_BUFFER_SIZE
+  usbRxCheck();
+#endif
+#ifdef CDC_TX_DOUBLE_BUFFER
+  usbBlockCheck();
+#endif
+  touchBench();
+  if (failures) {
+    printf("%d checks failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
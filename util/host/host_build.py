@@ -0,0 +1,85 @@
+#!/usr/bin/python
+
+# Builds the portable parts of the core for the host with gcc or clang, and
+# runs host_bench.c on them. Takes a second, no SDCC or board needed.
+#
+#   python host_build.py                 (gcc, CH552, -O2)
+#   python host_build.py --cc clang --cflags="-O0 -g -fsanitize=address"
+#   python host_build.py --define CDC_TX_DOUBLE_BUFFER   (only that build)
+#
+# Without --define it builds twice: with the default board settings, and
+# with the USB RX ring and double buffered IN, whose USB code host_bench.c
+# checks as well.
+#
+# ch55x_host.h turns SDCC keywords into plain C and the SFRs into globals.
+# Only files without 8051 assembly or hardware waits are built; wiring.c,
+# main.c and the interrupt vectors stay on the chip.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CH55X = os.path.join(HERE, "..", "..", "ch55xduino", "ch55x")
+CORE = os.path.join(CH55X, "cores", "ch55xduino")
+
+# extra defines of each build when --define is not given
+CONFIGS = [[], ["CDC_TX_DOUBLE_BUFFER", "USB_CDC_RX_BUFFER_SIZE=256"]]
+
+SOURCES = [
+    os.path.join(CORE, "Print.c"),
+    os.path.join(CORE, "Print-float.c"),
+    os.path.join(CORE, "Print-block.c"),
+    os.path.join(CORE, "WMath.c"),
+    os.path.join(CORE, "wiring_telemetry.c"),
+    os.path.join(CORE, "HardwareSerial0.c"),
+    os.path.join(CORE, "HardwareSerial0ISR.c"),
+    os.path.join(CORE, "USBhandler.c"),
+    os.path.join(CORE, "USBconstant.c"),
+    os.path.join(CORE, "USBCDC.c"),
+    os.path.join(CH55X, "libraries", "TouchKey", "src", "TouchKey.c"),
+    os.path.join(HERE, "host_bench.c"),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="host build of the CH55xduino core")
+    parser.add_argument("--cc", default="gcc", help="host C compiler")
+    parser.add_argument("--cflags", default="-O2", help="extra compiler flags")
+    parser.add_argument("--define", action="append", default=[],
+                        help="extra -D, for example SERIAL0_TX_BUFFER_SIZE=64")
+    args = parser.parse_args()
+
+    # the same defines as the default CH552 "USB CDC" board settings
+    defines = ["CH552", "F_CPU=24000000L", "EP0_ADDR=0", "EP1_ADDR=10",
+               "EP2_ADDR=20"]
+    # -fcommon merges the SFR globals every file declares through ch5xx.h.
+    # All warnings but three that SDCC code always triggers on the host:
+    # 16 bit pointers cast to uint16_t for the DMA registers, SDCC's own
+    # pragmas, and the REG & ~MASK | VALUE register idiom.
+    cmd = [args.cc, "-std=gnu99", "-fcommon", "-Wall",
+           "-Wno-pointer-to-int-cast", "-Wno-unknown-pragmas",
+           "-Wno-parentheses",
+           "-include", os.path.join(HERE, "ch55x_host.h"),
+           "-I", CORE, "-I", os.path.join(CH55X, "variants", "ch552"),
+           "-I", os.path.join(CH55X, "libraries", "TouchKey", "src")]
+    cmd += ["-D" + d for d in defines]
+    cmd += args.cflags.split()
+
+    failed = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = os.path.join(tmp, "host_bench")
+        for config in [args.define] if args.define else CONFIGS:
+            print("defines:", " ".join(config) or "(board defaults)",
+                  flush=True)
+            build = cmd + ["-D" + d for d in config] + SOURCES
+            if subprocess.run(build + ["-lm", "-o", exe]).returncode:
+                sys.exit("host build failed")
+            failed |= subprocess.run([exe]).returncode
+    sys.exit(failed)
+
+
+if __name__ == "__main__":
+    main()
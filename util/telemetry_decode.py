@@ -0,0 +1,140 @@
+#!/usr/bin/python
+
+# Decodes the binary records of Telemetry_send() / Telemetry_end() and prints
+# one line per record: type, sequence number and values.
+#
+#   python telemetry_decode.py /dev/ttyACM0 --record 1:fH
+#   python telemetry_decode.py COM5 --baud 115200 --record 1:fH --record 2:hhh
+#   python telemetry_decode.py capture.bin --record 1:fH
+#
+# A record layout is the type number and a Python struct format without the
+# byte order, little endian is added: B/b 1 byte, H/h 2 bytes (int on SDCC),
+# I/i 4 bytes (long), f float. Records of other types print their bytes in
+# hex. At the end, or on Ctrl-C, the frame, CRC error and lost record counts
+# go to stderr.
+#
+# Reading a serial port needs pyserial (pip install pyserial), files do not.
+
+import argparse
+import os
+import struct
+import sys
+
+
+def crc16(data):
+    # CRC-16/CCITT-FALSE, the same as Telemetry_end()
+    crc = 0xFFFF
+    for b in data:
+        x = ((crc >> 8) ^ b) & 0xFF
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, layouts):
+        self.layouts = layouts
+        self.buffer = bytearray()
+        self.frames = 0
+        self.errors = 0
+        self.lost = 0
+        self.sequence = None
+
+    def feed(self, data):
+        # yields (type, sequence, values) for each complete good record
+        self.buffer += data
+        while True:
+            end = self.buffer.find(0)
+            if end < 0:
+                return
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not frame:
+                continue
+            record = self.decode(frame)
+            if record is not None:
+                yield record
+
+    def decode(self, frame):
+        data = cobs_decode(frame)
+        if data is None or len(data) < 4 or \
+                crc16(data[:-2]) != struct.unpack("<H", data[-2:])[0]:
+            self.errors += 1
+            return None
+        self.frames += 1
+        kind, sequence = data[0], data[1]
+        if self.sequence is not None:
+            self.lost += (sequence - self.sequence - 1) & 0xFF
+        self.sequence = sequence
+        payload = data[2:-2]
+        layout = self.layouts.get(kind)
+        if layout is not None and struct.calcsize(layout) == len(payload):
+            values = struct.unpack(layout, payload)
+        else:
+            values = (payload.hex(),)
+        return kind, sequence, values
+
+
+def parse_record(text):
+    kind, _, layout = text.partition(":")
+    layout = "<" + layout
+    struct.calcsize(layout)  # raises on a bad format
+    return int(kind, 0), layout
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="CH55xduino telemetry decoder",
+        epilog="Reading a serial port needs pyserial (pip install pyserial).")
+    parser.add_argument("source", help="serial port (needs pyserial), or a file "
+                        "with captured bytes")
+    parser.add_argument("--baud", type=int, default=115200,
+                        help="serial baud rate, ignored by USB CDC (default 115200)")
+    parser.add_argument("--record", action="append", default=[], type=parse_record,
+                        help="TYPE:FORMAT, for example 1:fH")
+    args = parser.parse_args()
+
+    decoder = Decoder(dict(args.record))
+    is_file = os.path.isfile(args.source)
+    if is_file:
+        port = open(args.source, "rb")
+        read = lambda: port.read(4096)
+    else:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("reading a serial port needs pyserial: pip install pyserial")
+        port = serial.Serial(args.source, args.baud, timeout=0.1)
+        read = lambda: port.read(max(1, port.in_waiting))
+
+    try:
+        while True:
+            data = read()
+            if is_file and not data:
+                break
+            for kind, sequence, values in decoder.feed(data):
+                print(kind, sequence, *values, flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        port.close()
+        print(f"{decoder.frames} records, {decoder.errors} bad frames, "
+              f"{decoder.lost} lost", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,198 @@
+#!/usr/bin/python
+
+# Builds util/CoreBenchmark for each clock and runs it in the ucsim s51
+# simulator, no board needed.
+#
+#   python ucsim_benchmark.py --json report.json
+#   python ucsim_benchmark.py --baseline report.json    (exit 1 on regression)
+#   python ucsim_benchmark.py --log serial.txt          (parse a board's output)
+#   python ucsim_benchmark.py --size                     (printAll code size)
+#
+# Needs arduino-cli with the core installed, and s51 from the SDCC ucsim
+# package. Numbers are Timer2 ticks. In ucsim that is one classic 8051 machine
+# cycle, which does not match the CH55x instruction timing, so compare reports
+# with each other, not with the datasheet. Ticks are deterministic, any
+# increase over the baseline is reported.
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+SKETCH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "CoreBenchmark")
+SIZE_SKETCH = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                           "PrintAllSize")
+
+# (board, clock menu option, F_CPU), one per F_CPU
+TARGETS = [
+    ("ch552", "24internal", 24000000),
+    ("ch552", "16internal", 16000000),
+    ("ch552", "12internal", 12000000),
+    ("ch549", "32internal", 32000000),
+    ("ch559", "56internal", 56000000),
+]
+
+DELAY_TESTS = (10, 100, 1000)
+
+
+def parse_log(text):
+    # "BENCH <F_CPU>", "name ticks"..., "END"
+    f_cpu = None
+    ticks = {}
+    lines = text.splitlines()
+    if "END" not in lines:
+        return None
+    for line in lines:
+        fields = line.split()
+        if len(fields) != 2:
+            continue
+        if fields[0] == "BENCH":
+            f_cpu = int(fields[1])
+            ticks = {}
+        elif f_cpu is not None:
+            ticks[fields[0]] = None if fields[1] == "overflow" else int(fields[1])
+    if f_cpu is None:
+        return None
+    result = {"f_cpu": f_cpu, "ticks": ticks, "delay_error_pct": {}}
+    for us in DELAY_TESTS:
+        measured = ticks.get(f"delayMicroseconds_{us}")
+        if measured is not None:
+            expected = us * f_cpu / 12e6
+            result["delay_error_pct"][str(us)] = round(
+                (measured / expected - 1) * 100, 2)
+    return result
+
+
+def build(cli, config_dir, board, clock, out_dir):
+    cmd = [cli, "compile"]
+    if config_dir:
+        cmd += ["--config-dir", config_dir]
+    cmd += ["--fqbn", f"CH55xDuino:mcs51:{board}:clock={clock}",
+            "--output-dir", out_dir, SKETCH]
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+    return os.path.join(out_dir, "CoreBenchmark.ino.hex")
+
+
+def sketch_size(cli, config_dir, extra_flags):
+    # flash bytes of PrintAllSize on the default CH552 settings
+    cmd = [cli, "compile"]
+    if config_dir:
+        cmd += ["--config-dir", config_dir]
+    cmd += ["--fqbn", "CH55xDuino:mcs51:ch552",
+            "--build-property", f"build.extra_flags={extra_flags}", SIZE_SKETCH]
+    out = subprocess.run(cmd, check=True, capture_output=True, text=True).stdout
+    match = re.search(r"Sketch uses (\d+) bytes", out)
+    if match is None:
+        raise RuntimeError("no size in the arduino-cli output")
+    return int(match.group(1))
+
+
+def simulate(s51, hex_file, f_cpu, timeout):
+    with tempfile.TemporaryDirectory() as tmp:
+        log = os.path.join(tmp, "serial.txt")
+        open(log, "w").close()
+        # -G starts right away, -S sends the simulated UART to the file. s51
+        # keeps reading commands on stdin, so it is stopped once END shows up.
+        sim = subprocess.Popen([s51, "-t", "8052", "-X", str(f_cpu), "-G",
+                                "-S", f"out={log}", hex_file],
+                               stdin=subprocess.PIPE, stdout=subprocess.DEVNULL,
+                               stderr=subprocess.DEVNULL)
+        deadline = time.monotonic() + timeout
+        try:
+            while time.monotonic() < deadline:
+                with open(log) as fp:
+                    text = fp.read()
+                result = parse_log(text)
+                if result is not None:
+                    return result
+                time.sleep(0.2)
+        finally:
+            sim.kill()
+            sim.wait()
+    raise RuntimeError(f"{hex_file}: no END line after {timeout} s")
+
+
+def compare(report, baseline):
+    regressions = []
+    for target, result in report.items():
+        base = baseline.get(target)
+        if base is None:
+            continue
+        for name, ticks in result["ticks"].items():
+            old = base["ticks"].get(name)
+            if old is None and ticks is None:
+                continue
+            if old is None or (ticks is not None and ticks <= old):
+                continue
+            regressions.append(f"{target} {name}: {old} -> {ticks}")
+        for us, error in result["delay_error_pct"].items():
+            old = base["delay_error_pct"].get(us)
+            if old is not None and abs(error) > abs(old):
+                regressions.append(
+                    f"{target} delayMicroseconds({us}) error: {old}% -> {error}%")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="CH55xduino core benchmark in ucsim")
+    parser.add_argument("--cli", default="arduino-cli", help="arduino-cli command")
+    parser.add_argument("--config-dir", help="arduino-cli config directory")
+    parser.add_argument("--s51", default="s51", help="ucsim s51 command")
+    parser.add_argument("--timeout", type=float, default=60,
+                        help="seconds to wait for each simulation (default 60)")
+    parser.add_argument("--log", help="parse a saved serial log instead of simulating")
+    parser.add_argument("--json", help="write the report to this file")
+    parser.add_argument("--baseline", help="report to compare with")
+    parser.add_argument("--size", action="store_true",
+                        help="compare the code size of chained prints and printAll")
+    args = parser.parse_args()
+
+    if args.size:
+        chained = sketch_size(args.cli, args.config_dir, "-DPRINT_CHAINED")
+        print_all = sketch_size(args.cli, args.config_dir, "")
+        print(f"chained prints {chained:>6} bytes")
+        print(f"printAll       {print_all:>6} bytes ({print_all - chained:+d})")
+        return
+
+    report = {}
+    if args.log:
+        with open(args.log) as fp:
+            result = parse_log(fp.read())
+        if result is None:
+            sys.exit(f"{args.log}: no complete BENCH ... END block")
+        report["log"] = result
+    else:
+        with tempfile.TemporaryDirectory() as out_dir:
+            for board, clock, f_cpu in TARGETS:
+                target = f"{board}:{clock}"
+                print(f"building and simulating {target}", file=sys.stderr)
+                hex_file = build(args.cli, args.config_dir, board, clock,
+                                 os.path.join(out_dir, board + clock))
+                report[target] = simulate(args.s51, hex_file, f_cpu, args.timeout)
+
+    for target, result in report.items():
+        print(f"{target} ({result['f_cpu']} Hz)")
+        for name, ticks in result["ticks"].items():
+            print(f"  {name:28s} {'overflow' if ticks is None else ticks:>8}")
+        for us, error in result["delay_error_pct"].items():
+            print(f"  delayMicroseconds({us}) error {error:+.2f}%")
+
+    if args.json:
+        with open(args.json, "w") as fp:
+            json.dump(report, fp, indent=2, sort_keys=True)
+
+    if args.baseline:
+        with open(args.baseline) as fp:
+            regressions = compare(report, json.load(fp))
+        for line in regressions:
+            print("REGRESSION " + line)
+        if regressions:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()